@@ -2,56 +2,121 @@
 
 #include <smZInvAnalysis/BitsetCutflow.h>
 
+#include <cmath>
+
 /// this is needed to distribute the algorithm to the workers
 ClassImp(BitsetCutflow)
 
 BitsetCutflow::BitsetCutflow(EL::Worker *wk){
   m_wk = wk;
-  m_cutflowHist = new TH1I("cutflow_hist","Cutflow",99,-0.5,98.5);
-  m_wk->addOutput(m_cutflowHist);
-  m_cutflowStepCounter = 1;
-  m_cutflowHist->GetXaxis()->SetBinLabel(m_cutflowStepCounter,"All");
-  m_cutflowHist->Fill(0.0,-1.0); /// to compensate for the first event false filling
+  m_eventOpen = false;
+  m_eventWeight = 1.;
+  m_nEvents = 0;
+  m_sumW = 0.;
+  m_sumW2 = 0.;
+  m_nInvalidSteps = 0;
+  AddCutflow("");
 }
 
 BitsetCutflow::~BitsetCutflow(){
-  
+
+}
+
+unsigned int BitsetCutflow::AddCutflow(const string& name){
+  unsigned int cutflow = m_names.size();
+  m_names.push_back(name);
+  m_labels.push_back(vector<string>(1, "All"));
+  m_bits.push_back(0);
+  m_weights.push_back(1.);
+  m_counts.resize(m_names.size() * kMaxSteps, 0);
+  m_sumWs.resize(m_names.size() * kMaxSteps, 0.);
+  m_sumW2s.resize(m_names.size() * kMaxSteps, 0.);
+
+  string histName = name.empty() ? "cutflow_hist" : "cutflow_hist_" + name;
+  string title = name.empty() ? "Cutflow" : "Cutflow " + name;
+  TH1I* hist = new TH1I(histName.c_str(), title.c_str(), kMaxSteps, -0.5, kMaxSteps - 0.5);
+  TH1D* weighted = new TH1D((histName + "_weighted").c_str(), (title + " (weighted)").c_str(), kMaxSteps, -0.5, kMaxSteps - 0.5);
+  hist->GetXaxis()->SetBinLabel(1, "All");
+  weighted->GetXaxis()->SetBinLabel(1, "All");
+  m_wk->addOutput(hist);
+  m_wk->addOutput(weighted);
+  m_cutflowHists.push_back(hist);
+  m_weightedHists.push_back(weighted);
+
+  return cutflow;
+}
+
+unsigned int BitsetCutflow::AddStep(unsigned int cutflow, const string& label){
+  vector<string>& labels = m_labels.at(cutflow);
+  for (unsigned int step = 1; step < labels.size(); step++)
+    if (labels[step] == label) return step;
+
+  if (labels.size() == kMaxSteps) {
+    cerr << "BitsetCutflow::AddStep: more than " << kMaxSteps - 1 << " steps in cutflow '" << m_names[cutflow] << "', step '" << label << "' cannot be added" << endl;
+    m_nInvalidSteps++;
+    return kInvalidStep;
+  }
+
+  unsigned int step = labels.size();
+  labels.push_back(label);
+  m_cutflowHists[cutflow]->GetXaxis()->SetBinLabel(step + 1, label.c_str());
+  m_weightedHists[cutflow]->GetXaxis()->SetBinLabel(step + 1, label.c_str());
+  return step;
 }
 
 void BitsetCutflow::PushBitSet(){
-  
-  /// First bin: All events
-  m_cutflowHist->Fill(0);
-  
-  /// first and second bits will be always 0
-  for (unsigned i=1; i<=m_mapCutflowSteps.size(); i++){
-    /// first bit is always zero
-    if (m_bitset[i+1]!=m_bitset[0]) m_cutflowHist->Fill(i); 
+
+  /// the first call is at the beginning of the first event: nothing to count yet
+  if (m_eventOpen) {
+    /// First bin: All events
+    m_nEvents++;
+    m_sumW += m_eventWeight;
+    m_sumW2 += m_eventWeight * m_eventWeight;
+
+    /// only the cutflows passed in this event, only their set bits
+    for (unsigned int cutflow : m_touched) {
+      uint64_t bits = m_bits[cutflow];
+      double weight = m_weights[cutflow];
+      unsigned long* counts = &m_counts[cutflow * kMaxSteps];
+      double* sumW = &m_sumWs[cutflow * kMaxSteps];
+      double* sumW2 = &m_sumW2s[cutflow * kMaxSteps];
+      while (bits) {
+        unsigned int step = __builtin_ctzll(bits);
+        counts[step]++;
+        sumW[step] += weight;
+        sumW2[step] += weight * weight;
+        bits &= bits - 1;
+      }
+      /// clean bits for next event
+      m_bits[cutflow] = 0;
+    }
+    m_touched.clear();
   }
-  
-  /// clean bit for next event
-  m_bitset.reset();
+  m_eventOpen = true;
 }
 
-void BitsetCutflow::FillCutflow(string cutflowStepName, bool fillCutflow){
-  /// check if there is a slot already created for this cutflow step
-  if (fillCutflow){
-    unsigned int slotPosition = m_mapCutflowSteps[cutflowStepName];
-    if (slotPosition==0){
-      m_cutflowStepCounter++;
-      m_mapCutflowSteps[cutflowStepName] = m_cutflowStepCounter;
-      slotPosition = m_cutflowStepCounter;
-      m_cutflowHist->GetXaxis()->SetBinLabel(m_cutflowStepCounter,cutflowStepName.c_str());
+void BitsetCutflow::Finalize(){
+  for (unsigned int cutflow = 0; cutflow < m_names.size(); cutflow++) {
+    TH1I* hist = m_cutflowHists[cutflow];
+    TH1D* weighted = m_weightedHists[cutflow];
+    hist->SetBinContent(1, m_nEvents);
+    weighted->SetBinContent(1, m_sumW);
+    weighted->SetBinError(1, std::sqrt(m_sumW2));
+    for (unsigned int step = 1; step < m_labels[cutflow].size(); step++) {
+      unsigned int index = cutflow * kMaxSteps + step;
+      hist->SetBinContent(step + 1, m_counts[index]);
+      weighted->SetBinContent(step + 1, m_sumWs[index]);
+      weighted->SetBinError(step + 1, std::sqrt(m_sumW2s[index]));
     }
-    m_bitset[slotPosition]=1;
+    hist->SetEntries(m_nEvents);
+    weighted->SetEntries(m_nEvents);
   }
 }
 
-void BitsetCutflow::PrintCutflowLocally(){
-  for (int i=1; i<=m_cutflowHist->GetNbinsX(); i++){
-    int binContent = m_cutflowHist->GetBinContent(i);
-    if (binContent<=0) break;
-    string binLabel = m_cutflowHist->GetXaxis()->GetBinLabel(i);
-    cout << binLabel << ":\t" << binContent << endl;
+void BitsetCutflow::PrintCutflowLocally(unsigned int cutflow){
+  cout << (m_names[cutflow].empty() ? "cutflow_hist" : "cutflow_hist_" + m_names[cutflow]) << endl;
+  cout << m_labels[cutflow][0] << ":\t" << m_nEvents << endl;
+  for (unsigned int step = 1; step < m_labels[cutflow].size(); step++){
+    cout << m_labels[cutflow][step] << ":\t" << m_counts[cutflow * kMaxSteps + step] << endl;
   }
 }
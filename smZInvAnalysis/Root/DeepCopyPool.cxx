@@ -0,0 +1,27 @@
+#include <smZInvAnalysis/DeepCopyPool.h>
+
+#include <sstream>
+
+DeepCopyPool::DeepCopyPool()
+{
+}
+
+DeepCopyPool::~DeepCopyPool(){
+  // containers first: their remaining elements are deleted with them
+  for (auto& slot : m_slots) delete slot.second;
+  for (auto& freeList : m_freeLists) delete freeList.second;
+}
+
+void DeepCopyPool::Reset(){
+  for (auto& slot : m_slots) slot.second->Reset(*this);
+}
+
+std::string DeepCopyPool::Summary() const {
+
+  unsigned long nElements = 0;
+  for (const auto& freeList : m_freeLists) nElements += freeList.second->Allocated();
+
+  std::ostringstream out;
+  out << m_slots.size() << " pooled containers, " << nElements << " element objects allocated";
+  return out.str();
+}
@@ -0,0 +1,112 @@
+#include <smZInvAnalysis/EventSnapshot.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace {
+  // float arrays per collection (pt, eta, phi, m, rapidity, jvt, charge) followed by the bad flags
+  const unsigned int kNFloatArrays = 7;
+  const unsigned int kAlignment = 64;
+  // capacity granularity keeping every array 64-byte aligned
+  const unsigned int kCapacityStep = kAlignment / sizeof(float);
+}
+
+EventSnapshot::EventSnapshot() :
+  m_met(0.),
+  m_metPhi(0.)
+{
+  Resize(m_jets, 0);
+  Resize(m_osJets, 0);
+  Resize(m_muons, 0);
+  Resize(m_electrons, 0);
+}
+
+EventSnapshot::~EventSnapshot(){
+  free(m_jets.data);
+  free(m_osJets.data);
+  free(m_muons.data);
+  free(m_electrons.data);
+}
+
+void EventSnapshot::Resize(Block& block, unsigned int n){
+
+  unsigned int padded = Padded(n);
+  if (padded > block.capacity || !block.data) {
+    unsigned int capacity = (padded + kCapacityStep - 1) / kCapacityStep * kCapacityStep;
+    if (capacity < kCapacityStep) capacity = kCapacityStep;
+    void* data = 0;
+    if (posix_memalign(&data, kAlignment, capacity * (kNFloatArrays * sizeof(float) + 1)) != 0) throw std::bad_alloc();
+    free(block.data);
+    block.data = data;
+    block.capacity = capacity;
+
+    float* base = static_cast<float*>(data);
+    Objects& o = block.objects;
+    o.pt = base;
+    o.eta = base + capacity;
+    o.phi = base + 2 * capacity;
+    o.m = base + 3 * capacity;
+    o.rapidity = base + 4 * capacity;
+    o.jvt = base + 5 * capacity;
+    o.charge = base + 6 * capacity;
+    o.bad = reinterpret_cast<unsigned char*>(base + kNFloatArrays * capacity);
+  }
+
+  Objects& o = block.objects;
+  o.n = n;
+  unsigned int nPad = padded - n;
+  if (nPad == 0) return;
+  float* arrays[kNFloatArrays] = { o.pt, o.eta, o.phi, o.m, o.rapidity, o.jvt, o.charge };
+  for (unsigned int i = 0; i < kNFloatArrays; i++) memset(arrays[i] + n, 0, nPad * sizeof(float));
+  memset(o.bad + n, 0, nPad);
+}
+
+void EventSnapshot::FillJets(Block& block, const xAOD::JetContainer& jets){
+
+  static const SG::AuxElement::ConstAccessor<float> jvtAcc("Jvt");
+
+  Resize(block, jets.size());
+  Objects& o = block.objects;
+  for (unsigned int i = 0; i < o.n; i++) {
+    const xAOD::Jet* jet = jets[i];
+    o.pt[i] = jet->pt();
+    o.eta[i] = jet->eta();
+    o.phi[i] = jet->phi();
+    o.m[i] = jet->m();
+    o.rapidity[i] = jet->rapidity();
+    o.jvt[i] = jvtAcc.isAvailable(*jet) ? jvtAcc(*jet) : 0.;
+    o.charge[i] = 0.;
+    o.bad[i] = 0;
+  }
+}
+
+template <class CONT>
+void EventSnapshot::FillLeptons(Block& block, const CONT& leptons){
+
+  Resize(block, leptons.size());
+  Objects& o = block.objects;
+  for (unsigned int i = 0; i < o.n; i++) {
+    const auto* lepton = leptons[i];
+    o.pt[i] = lepton->pt();
+    o.eta[i] = lepton->eta();
+    o.phi[i] = lepton->phi();
+    o.m[i] = lepton->m();
+    o.rapidity[i] = lepton->rapidity();
+    o.jvt[i] = 0.;
+    o.charge[i] = lepton->charge();
+    o.bad[i] = 0;
+  }
+}
+
+void EventSnapshot::Fill(const xAOD::JetContainer& jets, const xAOD::JetContainer& osJets,
+    const xAOD::MuonContainer& muons, const xAOD::ElectronContainer& electrons,
+    float met, float metPhi){
+
+  FillJets(m_jets, jets);
+  FillJets(m_osJets, osJets);
+  FillLeptons(m_muons, muons);
+  FillLeptons(m_electrons, electrons);
+  m_met = met;
+  m_metPhi = metPhi;
+}
@@ -0,0 +1,75 @@
+#include <smZInvAnalysis/FlatNtuple.h>
+
+FlatNtuple::FlatNtuple(TDirectory* dir, const std::string& name) :
+  m_runNumber(0),
+  m_eventNumber(0)
+{
+  m_tree = new TTree(name.c_str(), "smZInvAnalysis flat ntuple (one row per selected event and channel)");
+  m_tree->SetDirectory(dir);
+
+  FlatNtupleRow& r = m_row;
+  m_tree->Branch("runNumber", &r.runNumber, "runNumber/I");
+  m_tree->Branch("eventNumber", &r.eventNumber, "eventNumber/l");
+  m_tree->Branch("channel", &r.channel, "channel/I");
+  m_tree->Branch("cutMask", &r.cutMask, "cutMask/I");
+
+  m_tree->Branch("weight", &r.weight, "weight/F");
+  m_tree->Branch("lepSF", &r.lepSF, "lepSF/F");
+  m_tree->Branch("metTrigSF_exclusive", &r.metTrigSF_exclusive, "metTrigSF_exclusive/F");
+  m_tree->Branch("metTrigSF_inclusive", &r.metTrigSF_inclusive, "metTrigSF_inclusive/F");
+
+  m_tree->Branch("met", &r.met, "met/F");
+  m_tree->Branch("met_phi", &r.met_phi, "met_phi/F");
+  m_tree->Branch("mll", &r.mll, "mll/F");
+  m_tree->Branch("mT", &r.mT, "mT/F");
+  m_tree->Branch("mjj", &r.mjj, "mjj/F");
+
+  m_tree->Branch("nJet", &r.nJet, "nJet/I");
+  m_tree->Branch("jet_pt", r.jet_pt, "jet_pt[nJet]/F");
+  m_tree->Branch("jet_eta", r.jet_eta, "jet_eta[nJet]/F");
+  m_tree->Branch("jet_phi", r.jet_phi, "jet_phi[nJet]/F");
+  m_tree->Branch("jet_m", r.jet_m, "jet_m[nJet]/F");
+
+  m_tree->Branch("nLep", &r.nLep, "nLep/I");
+  m_tree->Branch("lep_pt", r.lep_pt, "lep_pt[nLep]/F");
+  m_tree->Branch("lep_eta", r.lep_eta, "lep_eta[nLep]/F");
+  m_tree->Branch("lep_phi", r.lep_phi, "lep_phi[nLep]/F");
+  m_tree->Branch("lep_charge", r.lep_charge, "lep_charge[nLep]/F");
+
+  // Flush a cluster every ~16 MB. At the first flush ROOT resizes the baskets
+  // so that every branch holds a whole cluster in one basket, i.e. a column
+  // is read with one I/O and one decompression per cluster.
+  m_tree->SetAutoFlush(-16 * 1024 * 1024);
+
+  Clear();
+}
+
+void FlatNtuple::SetEvent(int runNumber, ULong64_t eventNumber){
+  m_runNumber = runNumber;
+  m_eventNumber = eventNumber;
+}
+
+void FlatNtuple::Fill(){
+  m_row.runNumber = m_runNumber;
+  m_row.eventNumber = m_eventNumber;
+  if (m_row.nJet > FlatNtupleRow::kMaxJets) m_row.nJet = FlatNtupleRow::kMaxJets;
+  if (m_row.nLep > FlatNtupleRow::kMaxLeptons) m_row.nLep = FlatNtupleRow::kMaxLeptons;
+  m_tree->Fill();
+  Clear();
+}
+
+void FlatNtuple::Clear(){
+  m_row.channel = -1;
+  m_row.cutMask = 0;
+  m_row.weight = 1.;
+  m_row.lepSF = 1.;
+  m_row.metTrigSF_exclusive = 1.;
+  m_row.metTrigSF_inclusive = 1.;
+  m_row.met = -1.;
+  m_row.met_phi = -9.;
+  m_row.mll = -1.;
+  m_row.mT = -1.;
+  m_row.mjj = -1.;
+  m_row.nJet = 0;
+  m_row.nLep = 0;
+}
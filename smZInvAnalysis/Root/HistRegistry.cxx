@@ -0,0 +1,325 @@
+#include <smZInvAnalysis/HistRegistry.h>
+
+#include <TH1F.h>
+#include <TH2F.h>
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+  // Alphabetical, which is the iteration order of the per-event scale-weight maps
+  const char* const kScaleWeightNames[HistRegistry::kNScaleWeights] = {
+    "MUR05_MUF05", "MUR05_MUF1", "MUR1_MUF05", "MUR1_MUF2", "MUR2_MUF1", "MUR2_MUF2", "NOMINAL"
+  };
+
+  // FNV-1a, fed piece by piece so that no key string has to be built
+  inline uint64_t hashBytes(uint64_t h, const char* data, std::size_t n) {
+    for (std::size_t i = 0; i < n; i++) {
+      h ^= (unsigned char)data[i];
+      h *= 1099511628211ULL;
+    }
+    return h;
+  }
+
+  inline uint64_t hashKey(const HistTemplates* t, const std::string& c, const std::string& p, const std::string& s) {
+    uint64_t h = 14695981039346656037ULL;
+    uintptr_t ptr = reinterpret_cast<uintptr_t>(t);
+    h = hashBytes(h, reinterpret_cast<const char*>(&ptr), sizeof(ptr));
+    h = hashBytes(h, c.data(), c.size()); h = hashBytes(h, "\0", 1);
+    h = hashBytes(h, p.data(), p.size()); h = hashBytes(h, "\0", 1);
+    h = hashBytes(h, s.data(), s.size());
+    return h;
+  }
+
+  // bytes per bin of a TH1F/TH2F/THnSparseF: the content, and its sum of weights^2 if stored
+  inline double bytesPerBin(bool sumw2) {
+    return sizeof(Float_t) + (sumw2 ? sizeof(Double_t) : 0);
+  }
+
+}
+
+const char* HistRegistry::ScaleWeightName(int i){
+  return kScaleWeightNames[i];
+}
+
+HistRegistry::HistRegistry(EL::Worker* wk) :
+  m_wk(wk),
+  m_lazy(false),
+  m_missedFills(0)
+{
+}
+
+HistRegistry::~HistRegistry(){
+  for (MultiWeightHist* group : m_groups) delete group;
+}
+
+bool HistRegistry::ScaledWeights(const std::map<std::string, float>& mcWeights, float mcEventWeight, float sf, double* weights){
+  std::map<std::string, float>::const_iterator nominal = mcWeights.find("NOMINAL");
+  if (nominal == mcWeights.end()) return false;
+  float pu_weight = mcEventWeight / nominal->second; // Retrieve PU weight
+  for (int w = 0; w < kNScaleWeights; w++) {
+    std::map<std::string, float>::const_iterator it = mcWeights.find(kScaleWeightNames[w]);
+    if (it == mcWeights.end()) return false;
+    float mcScaledWeight = it->second * pu_weight * sf;
+    weights[w] = mcScaledWeight;
+  }
+  return true;
+}
+
+void HistRegistry::Flush(){
+  for (MultiWeightHist* group : m_groups)
+    if (group) group->Flush();
+}
+
+int HistRegistry::Register(TH1* h, TH2* h2){
+  int handle = m_hists.size();
+  m_hists.push_back(h);
+  m_hists2D.push_back(h2);
+  m_sparse.push_back(0);
+  m_index[h->GetName()] = handle; // rebooking a name points it to the newest histogram, as hMap[label] did
+  return handle;
+}
+
+int HistRegistry::Book(const Spec& spec){
+  int handle = m_hists.size();
+  m_hists.push_back(0);
+  m_hists2D.push_back(0);
+  m_sparse.push_back(0);
+  m_index[spec.name] = handle;
+  m_pending[handle] = spec;
+  if (!m_lazy) Create(handle);
+  return handle;
+}
+
+int HistRegistry::Book1D(const std::string& name, int bins, double min, double max){
+  Spec spec = { name, bins, 0, min, max, 0., 0., std::vector<double>(), std::vector<double>(), false };
+  return Book(spec);
+}
+
+int HistRegistry::Book1D(const std::string& name, int bins, const Float_t* edges){
+  Spec spec = { name, bins, 0, edges[0], edges[bins], 0., 0., std::vector<double>(edges, edges + bins + 1), std::vector<double>(), false };
+  return Book(spec);
+}
+
+int HistRegistry::Book2D(const std::string& name, int binsX, double minX, double maxX, int binsY, double minY, double maxY){
+  Spec spec = { name, binsX, binsY, minX, maxX, minY, maxY, std::vector<double>(), std::vector<double>(), false };
+  return Book(spec);
+}
+
+int HistRegistry::Book2D(const std::string& name, int binsX, const Float_t* edgesX, int binsY, const Float_t* edgesY, bool sparse){
+  Spec spec = { name, binsX, binsY, edgesX[0], edgesX[binsX], edgesY[0], edgesY[binsY],
+    std::vector<double>(edgesX, edgesX + binsX + 1), std::vector<double>(edgesY, edgesY + binsY + 1), sparse };
+  return Book(spec);
+}
+
+void HistRegistry::Create(int handle){
+  std::unordered_map<int, Spec>::iterator it = m_pending.find(handle);
+  if (it == m_pending.end()) return;
+  const Spec& spec = it->second;
+  const char* name = spec.name.c_str();
+
+  TObject* output = 0;
+  if (spec.sparse) {
+    // same axes as the TH2F would have (the edges were Float_t there too)
+    int bins[2] = { spec.binsX, spec.binsY };
+    double min[2] = { spec.minX, spec.minY };
+    double max[2] = { spec.maxX, spec.maxY };
+    THnSparse* h = new THnSparseF(name, "", 2, bins, min, max);
+    if (!spec.edgesX.empty()) h->SetBinEdges(0, spec.edgesX.data());
+    if (!spec.edgesY.empty()) h->SetBinEdges(1, spec.edgesY.data());
+    if (TH1::GetDefaultSumw2()) h->Sumw2();
+    m_sparse[handle] = h;
+    output = h;
+  }
+  else if (spec.binsY == 0) {
+    TH1* h = spec.edgesX.empty() ? new TH1F(name, "", spec.binsX, spec.minX, spec.maxX)
+      : new TH1F(name, "", spec.binsX, spec.edgesX.data());
+    h->SetDirectory(0); // may be created in execute(), while an input file is the current directory
+    m_hists[handle] = h;
+    output = h;
+  }
+  else {
+    TH2* h = spec.edgesX.empty() ? new TH2F(name, "", spec.binsX, spec.minX, spec.maxX, spec.binsY, spec.minY, spec.maxY)
+      : new TH2F(name, "", spec.binsX, spec.edgesX.data(), spec.binsY, spec.edgesY.data());
+    h->SetDirectory(0);
+    m_hists[handle] = h;
+    m_hists2D[handle] = h;
+    output = h;
+  }
+  m_pending.erase(it);
+
+  if (m_wk) m_wk->addOutput(output);
+}
+
+void HistRegistry::FillSlow1D(int handle, double x, double w){
+  if (handle >= 0 && !m_hists[handle]) Create(handle);
+  if (handle >= 0 && m_hists[handle]) m_hists[handle]->Fill(x, w);
+  else m_missedFills++;
+}
+
+void HistRegistry::FillSlow2D(int handle, double x, double y, double w){
+  if (handle >= 0 && !m_hists[handle] && !m_sparse[handle]) Create(handle);
+  if (handle >= 0 && m_hists2D[handle]) {
+    m_hists2D[handle]->Fill(x, y, w);
+  }
+  else if (handle >= 0 && m_sparse[handle]) {
+    double xy[2] = { x, y };
+    m_sparse[handle]->Fill(xy, w);
+  }
+  else {
+    m_missedFills++;
+  }
+}
+
+void HistRegistry::FillSlowWeights(int group, double x, const double* w){
+  if (group < 0) {
+    m_missedFills++;
+    return;
+  }
+  std::vector<TH1*> hists;
+  for (int handle : m_groupHandles[group]) {
+    if (!m_hists[handle]) Create(handle);
+    if (!m_hists[handle]) {
+      m_missedFills++; // booked sparse or 2D, not a weight group member
+      return;
+    }
+    hists.push_back(m_hists[handle]);
+  }
+  m_groups[group] = new MultiWeightHist(hists);
+  m_groups[group]->Fill(x, w);
+}
+
+std::string HistRegistry::MemorySummary() const {
+  unsigned long nCreated = 0;
+  unsigned long nSparse = 0;
+  double used = 0.;
+  double dense = 0.;
+  for (unsigned int handle = 0; handle < m_hists.size(); handle++) {
+    if (m_sparse[handle]) {
+      THnSparse* h = m_sparse[handle];
+      double bytes = bytesPerBin(h->GetCalculateErrors());
+      for (int d = 0; d < h->GetNdimensions(); d++) bytes *= h->GetAxis(d)->GetNbins() + 2;
+      used += bytes * h->GetSparseFractionMem();
+      dense += bytes;
+      nCreated++;
+      nSparse++;
+    }
+    else if (m_hists[handle]) {
+      double bytes = m_hists[handle]->GetNcells() * bytesPerBin(m_hists[handle]->GetSumw2N() > 0);
+      used += bytes;
+      dense += bytes;
+      nCreated++;
+    }
+    else {
+      std::unordered_map<int, Spec>::const_iterator it = m_pending.find(handle);
+      if (it == m_pending.end()) continue;
+      double cells = (it->second.binsX + 2.) * (it->second.binsY ? it->second.binsY + 2. : 1.);
+      dense += cells * bytesPerBin(TH1::GetDefaultSumw2());
+    }
+  }
+  double groups = 0.;
+  for (const MultiWeightHist* group : m_groups)
+    if (group) groups += group->Bytes();
+
+  char summary[256];
+  snprintf(summary, sizeof(summary), "%lu of %lu histograms created (%lu sparse), bins %.1f MB (%.1f MB if all were booked dense), weight groups %.1f MB",
+      nCreated, (unsigned long)m_hists.size(), nSparse, used / 1048576., dense / 1048576., groups / 1048576.);
+  return summary;
+}
+
+int HistRegistry::Add(TH1* h){
+  return Register(h, 0);
+}
+
+int HistRegistry::Add(TH2* h){
+  return Register(h, h);
+}
+
+int HistRegistry::Find(const std::string& name) const {
+  std::unordered_map<std::string, int>::const_iterator it = m_index.find(name);
+  if (it == m_index.end()) return -1;
+  return it->second;
+}
+
+std::string HistRegistry::Expand(const char* name, const std::string& channel, const std::string& prefix,
+    const std::string& sysName, int weight) const {
+
+  std::string out;
+  out.reserve(std::strlen(name) + channel.size() + prefix.size() + sysName.size() + 16);
+  for (const char* c = name; *c; c++) {
+    if (c[0] == '{' && c[1] && c[2] == '}') {
+      switch (c[1]) {
+        case 'c': out += channel; c += 2; continue;
+        case 'p': out += prefix; c += 2; continue;
+        case 's': out += sysName; c += 2; continue;
+        case 'w': out += kScaleWeightNames[weight]; c += 2; continue;
+        default: break;
+      }
+    }
+    out += *c;
+  }
+  return out;
+}
+
+int HistRegistry::Group(const char* name, const std::string& channel, const std::string& prefix, const std::string& sysName){
+  std::vector<int> handles;
+  for (int w = 0; w < kNScaleWeights; w++) {
+    int handle = Find(Expand(name, channel, prefix, sysName, w));
+    if (handle < 0) return -1; // not booked for this context, fills are counted as missed
+    handles.push_back(handle);
+  }
+  int first = handles[0];
+
+  // several blocks (e.g. the same prefix in two template lists) share one group
+  std::unordered_map<int, int>::const_iterator it = m_groupIndex.find(first);
+  if (it != m_groupIndex.end()) return it->second;
+
+  // the MultiWeightHist (and the histograms, if booked lazily) is created on the first fill
+  int group = m_groups.size();
+  m_groups.push_back(0);
+  m_groupHandles.push_back(handles);
+  m_groupIndex[first] = group;
+  return group;
+}
+
+const int* HistRegistry::Block(const HistTemplates& templates, const std::string& channel,
+    const std::string& prefix, const std::string& sysName){
+
+  uint64_t key = hashKey(&templates, channel, prefix, sysName);
+  auto range = m_blockIndex.equal_range(key);
+  for (auto it = range.first; it != range.second; ++it) {
+    const BlockKey& k = m_blockKeys[it->second];
+    if (k.templates == &templates && k.channel == channel && k.prefix == prefix && k.sysName == sysName)
+      return m_blocks[it->second].data();
+  }
+
+  // First use of this context: build the names once and look them up
+  std::vector<int> handles;
+  handles.reserve(templates.nSlots);
+  for (unsigned int i = 0; i < templates.nNames; i++) {
+    const char* name = templates.names[i];
+    if (std::strstr(name, "{w}")) {
+      handles.push_back(Group(name, channel, prefix, sysName));
+    }
+    else {
+      handles.push_back(Find(Expand(name, channel, prefix, sysName, 0)));
+    }
+  }
+  if (handles.size() != templates.nSlots) {
+    std::cerr << "HistRegistry: template list has " << handles.size() << " slots, expected " << templates.nSlots << std::endl;
+    handles.resize(templates.nSlots, -1);
+  }
+
+  BlockKey k;
+  k.templates = &templates;
+  k.channel = channel;
+  k.prefix = prefix;
+  k.sysName = sysName;
+  m_blockKeys.push_back(k);
+  m_blocks.push_back(handles);
+  m_blockIndex.insert(std::make_pair(key, (unsigned int)(m_blocks.size() - 1)));
+
+  return m_blocks.back().data();
+}
@@ -0,0 +1,248 @@
+#include <smZInvAnalysis/KinematicKernels.h>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KINEMATICKERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+  const float kPi = 3.14159265358979323846f;
+  const float kTwoPi = 6.28318530717958647692f;
+  const float kNoObject = 9.; // as the dRmin start value of the overlap removal loops
+
+  //--------
+  // Scalar
+  //--------
+
+  inline float scalarDeltaPhi(float phi1, float phi2){
+    float dPhi = std::fabs(phi1 - phi2);
+    if (dPhi > kPi) dPhi = kTwoPi - dPhi;
+    return dPhi;
+  }
+
+  inline float scalarDeltaR(float eta1, float phi1, float eta2, float phi2){
+    float dEta = eta1 - eta2;
+    float dPhi = scalarDeltaPhi(phi1, phi2);
+    return std::sqrt(dEta*dEta + dPhi*dPhi);
+  }
+
+  float minDeltaPhiScalar(const float* phi, unsigned int n, float phiRef){
+    float dPhiMin = kNoObject;
+    for (unsigned int i = 0; i < n; i++) dPhiMin = std::min(dPhiMin, scalarDeltaPhi(phi[i], phiRef));
+    return dPhiMin;
+  }
+
+  // dRmin[i] for i in [first, n1)
+  void minDeltaRTail(const float* eta1, const float* phi1, unsigned int first, unsigned int n1,
+      const float* eta2, const float* phi2, unsigned int n2, float* dRmin){
+    for (unsigned int i = first; i < n1; i++) {
+      float m = kNoObject;
+      for (unsigned int j = 0; j < n2; j++) m = std::min(m, scalarDeltaR(eta1[i], phi1[i], eta2[j], phi2[j]));
+      dRmin[i] = m;
+    }
+  }
+
+  // one row of the deltaR matrix: object (eta, phi) against all of array 2
+  void deltaRRow(float eta, float phi, const float* eta2, const float* phi2, unsigned int n2, float* row){
+    for (unsigned int j = 0; j < n2; j++) row[j] = scalarDeltaR(eta, phi, eta2[j], phi2[j]);
+  }
+
+  void minDeltaRScalar(const float* eta1, const float* phi1, unsigned int n1,
+      const float* eta2, const float* phi2, unsigned int n2, float* dRmin){
+    minDeltaRTail(eta1, phi1, 0, n1, eta2, phi2, n2, dRmin);
+  }
+
+  void deltaRScalar(const float* eta1, const float* phi1, unsigned int n1,
+      const float* eta2, const float* phi2, unsigned int n2, float* dR){
+    for (unsigned int i = 0; i < n1; i++) deltaRRow(eta1[i], phi1[i], eta2, phi2, n2, dR + i*n2);
+  }
+
+#ifdef KINEMATICKERNELS_X86
+
+  //------
+  // SSE2
+  //------
+  // |a - b| folded into [0, pi]: min(d, 2pi - d) is the same as the scalar branch for d in [0, 2pi]
+
+  __attribute__((target("sse2"))) inline __m128 deltaPhi4(__m128 phi1, __m128 phi2){
+    const __m128 signMask = _mm_set1_ps(-0.f);
+    __m128 dPhi = _mm_andnot_ps(signMask, _mm_sub_ps(phi1, phi2));
+    return _mm_min_ps(dPhi, _mm_sub_ps(_mm_set1_ps(kTwoPi), dPhi));
+  }
+
+  __attribute__((target("sse2"))) inline __m128 deltaR4(__m128 eta1, __m128 phi1, __m128 eta2, __m128 phi2){
+    __m128 dEta = _mm_sub_ps(eta1, eta2);
+    __m128 dPhi = deltaPhi4(phi1, phi2);
+    return _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dEta, dEta), _mm_mul_ps(dPhi, dPhi)));
+  }
+
+  __attribute__((target("sse2"))) float minDeltaPhiSSE2(const float* phi, unsigned int n, float phiRef){
+    const __m128 ref = _mm_set1_ps(phiRef);
+    __m128 dPhiMin = _mm_set1_ps(kNoObject);
+    unsigned int i = 0;
+    for (; i + 4 <= n; i += 4) dPhiMin = _mm_min_ps(dPhiMin, deltaPhi4(_mm_loadu_ps(phi + i), ref));
+    float lanes[4];
+    _mm_storeu_ps(lanes, dPhiMin);
+    float m = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+    return std::min(m, minDeltaPhiScalar(phi + i, n - i, phiRef));
+  }
+
+  __attribute__((target("sse2"))) void minDeltaRSSE2(const float* eta1, const float* phi1, unsigned int n1,
+      const float* eta2, const float* phi2, unsigned int n2, float* dRmin){
+    unsigned int i = 0;
+    for (; i + 4 <= n1; i += 4) {
+      __m128 eta = _mm_loadu_ps(eta1 + i);
+      __m128 phi = _mm_loadu_ps(phi1 + i);
+      __m128 m = _mm_set1_ps(kNoObject);
+      for (unsigned int j = 0; j < n2; j++) m = _mm_min_ps(m, deltaR4(eta, phi, _mm_set1_ps(eta2[j]), _mm_set1_ps(phi2[j])));
+      _mm_storeu_ps(dRmin + i, m);
+    }
+    minDeltaRTail(eta1, phi1, i, n1, eta2, phi2, n2, dRmin);
+  }
+
+  // columns j of the matrix, four objects of array 1 at a time (array 1 is the longer one, the jets)
+  __attribute__((target("sse2"))) void deltaRSSE2(const float* eta1, const float* phi1, unsigned int n1,
+      const float* eta2, const float* phi2, unsigned int n2, float* dR){
+    unsigned int i = 0;
+    for (; i + 4 <= n1; i += 4) {
+      __m128 eta = _mm_loadu_ps(eta1 + i);
+      __m128 phi = _mm_loadu_ps(phi1 + i);
+      for (unsigned int j = 0; j < n2; j++) {
+        float lanes[4];
+        _mm_storeu_ps(lanes, deltaR4(eta, phi, _mm_set1_ps(eta2[j]), _mm_set1_ps(phi2[j])));
+        for (unsigned int k = 0; k < 4; k++) dR[(i+k)*n2 + j] = lanes[k];
+      }
+    }
+    for (; i < n1; i++) deltaRRow(eta1[i], phi1[i], eta2, phi2, n2, dR + i*n2);
+  }
+
+  //------
+  // AVX2
+  //------
+
+  __attribute__((target("avx2"))) inline __m256 deltaPhi8(__m256 phi1, __m256 phi2){
+    const __m256 signMask = _mm256_set1_ps(-0.f);
+    __m256 dPhi = _mm256_andnot_ps(signMask, _mm256_sub_ps(phi1, phi2));
+    return _mm256_min_ps(dPhi, _mm256_sub_ps(_mm256_set1_ps(kTwoPi), dPhi));
+  }
+
+  __attribute__((target("avx2"))) inline __m256 deltaR8(__m256 eta1, __m256 phi1, __m256 eta2, __m256 phi2){
+    __m256 dEta = _mm256_sub_ps(eta1, eta2);
+    __m256 dPhi = deltaPhi8(phi1, phi2);
+    return _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dEta, dEta), _mm256_mul_ps(dPhi, dPhi)));
+  }
+
+  // eight objects at a time, then one SSE2 step of four, then one by one
+
+  __attribute__((target("avx2"))) float minDeltaPhiAVX2(const float* phi, unsigned int n, float phiRef){
+    const __m256 ref = _mm256_set1_ps(phiRef);
+    __m256 dPhiMin = _mm256_set1_ps(kNoObject);
+    unsigned int i = 0;
+    for (; i + 8 <= n; i += 8) dPhiMin = _mm256_min_ps(dPhiMin, deltaPhi8(_mm256_loadu_ps(phi + i), ref));
+    __m128 m4 = _mm_min_ps(_mm256_castps256_ps128(dPhiMin), _mm256_extractf128_ps(dPhiMin, 1));
+    if (i + 4 <= n) {
+      m4 = _mm_min_ps(m4, deltaPhi4(_mm_loadu_ps(phi + i), _mm_set1_ps(phiRef)));
+      i += 4;
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, m4);
+    float m = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+    return std::min(m, minDeltaPhiScalar(phi + i, n - i, phiRef));
+  }
+
+  __attribute__((target("avx2"))) void minDeltaRAVX2(const float* eta1, const float* phi1, unsigned int n1,
+      const float* eta2, const float* phi2, unsigned int n2, float* dRmin){
+    unsigned int i = 0;
+    for (; i + 8 <= n1; i += 8) {
+      __m256 eta = _mm256_loadu_ps(eta1 + i);
+      __m256 phi = _mm256_loadu_ps(phi1 + i);
+      __m256 m = _mm256_set1_ps(kNoObject);
+      for (unsigned int j = 0; j < n2; j++) m = _mm256_min_ps(m, deltaR8(eta, phi, _mm256_set1_ps(eta2[j]), _mm256_set1_ps(phi2[j])));
+      _mm256_storeu_ps(dRmin + i, m);
+    }
+    if (i + 4 <= n1) {
+      __m128 eta = _mm_loadu_ps(eta1 + i);
+      __m128 phi = _mm_loadu_ps(phi1 + i);
+      __m128 m = _mm_set1_ps(kNoObject);
+      for (unsigned int j = 0; j < n2; j++) m = _mm_min_ps(m, deltaR4(eta, phi, _mm_set1_ps(eta2[j]), _mm_set1_ps(phi2[j])));
+      _mm_storeu_ps(dRmin + i, m);
+      i += 4;
+    }
+    minDeltaRTail(eta1, phi1, i, n1, eta2, phi2, n2, dRmin);
+  }
+
+  __attribute__((target("avx2"))) void deltaRAVX2(const float* eta1, const float* phi1, unsigned int n1,
+      const float* eta2, const float* phi2, unsigned int n2, float* dR){
+    unsigned int i = 0;
+    for (; i + 8 <= n1; i += 8) {
+      __m256 eta = _mm256_loadu_ps(eta1 + i);
+      __m256 phi = _mm256_loadu_ps(phi1 + i);
+      for (unsigned int j = 0; j < n2; j++) {
+        float lanes[8];
+        _mm256_storeu_ps(lanes, deltaR8(eta, phi, _mm256_set1_ps(eta2[j]), _mm256_set1_ps(phi2[j])));
+        for (unsigned int k = 0; k < 8; k++) dR[(i+k)*n2 + j] = lanes[k];
+      }
+    }
+    if (i + 4 <= n1) {
+      __m128 eta = _mm_loadu_ps(eta1 + i);
+      __m128 phi = _mm_loadu_ps(phi1 + i);
+      for (unsigned int j = 0; j < n2; j++) {
+        float lanes[4];
+        _mm_storeu_ps(lanes, deltaR4(eta, phi, _mm_set1_ps(eta2[j]), _mm_set1_ps(phi2[j])));
+        for (unsigned int k = 0; k < 4; k++) dR[(i+k)*n2 + j] = lanes[k];
+      }
+      i += 4;
+    }
+    for (; i < n1; i++) deltaRRow(eta1[i], phi1[i], eta2, phi2, n2, dR + i*n2);
+  }
+
+#endif
+
+}
+
+const KinematicKernels::Functions& KinematicKernels::Table(Implementation implementation){
+
+  static const Functions scalar = { minDeltaPhiScalar, minDeltaRScalar, deltaRScalar, kScalar };
+#ifdef KINEMATICKERNELS_X86
+  static const Functions sse2 = { minDeltaPhiSSE2, minDeltaRSSE2, deltaRSSE2, kSSE2 };
+  static const Functions avx2 = { minDeltaPhiAVX2, minDeltaRAVX2, deltaRAVX2, kAVX2 };
+  if (implementation == kAVX2) return avx2;
+  if (implementation == kSSE2) return sse2;
+#endif
+  return scalar;
+}
+
+// chosen during static initialisation; Get() also covers use from other static initialisers
+const KinematicKernels::Functions* KinematicKernels::s_functions = &KinematicKernels::Table(KinematicKernels::Best());
+
+KinematicKernels::Implementation KinematicKernels::Best(){
+
+#ifdef KINEMATICKERNELS_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return kAVX2;
+  if (__builtin_cpu_supports("sse2")) return kSSE2;
+#endif
+  return kScalar;
+}
+
+KinematicKernels::Implementation KinematicKernels::Selected(){
+  return Get().implementation;
+}
+
+bool KinematicKernels::Select(Implementation implementation){
+
+  if (implementation > Best()) return false;
+  s_functions = &Table(implementation);
+  return true;
+}
+
+const char* KinematicKernels::Name(Implementation implementation){
+
+  static const char* const names[kNImplementations] = { "scalar", "SSE2", "AVX2" };
+  if (implementation < 0 || implementation >= kNImplementations) return "unknown";
+  return names[implementation];
+}
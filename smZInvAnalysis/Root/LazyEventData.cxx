@@ -0,0 +1,25 @@
+#include <smZInvAnalysis/LazyEventData.h>
+
+#include <sstream>
+
+LazyEventData::LazyEventData(xAOD::TEvent* event) :
+  m_event(event),
+  m_nEvents(0)
+{
+}
+
+void LazyEventData::Reset(){
+  // keep the map nodes, only invalidate the pointers
+  for (auto& entry : m_entries) entry.second.cached = false;
+  m_nEvents++;
+}
+
+std::string LazyEventData::Summary() const {
+
+  std::ostringstream out;
+  out << m_nEvents << " events";
+  for (const auto& entry : m_entries) {
+    out << "\n  " << entry.first << " read in " << entry.second.nRead << " events";
+  }
+  return out.str();
+}
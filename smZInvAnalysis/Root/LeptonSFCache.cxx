@@ -0,0 +1,40 @@
+#include <smZInvAnalysis/LeptonSFCache.h>
+
+#include <cstdio>
+#include <limits>
+
+LeptonSFCache::LeptonSFCache() :
+  m_values("smZInv_leptonSF"),
+  m_key("smZInv_leptonSFKey"),
+  m_currentKey(0),
+  m_nSlots(0),
+  m_slot(0),
+  m_evaluations(0),
+  m_reads(0)
+{
+}
+
+void LeptonSFCache::Begin(unsigned int nSlots){
+  // key 0 is never used, so that a lepton that was never added cannot match
+  m_currentKey++;
+  if (m_currentKey == 0) m_currentKey = 1;
+  m_nSlots = nSlots;
+  m_slot = 0;
+}
+
+void LeptonSFCache::Add(const SG::AuxElement& lepton){
+  m_values(lepton).assign(m_nSlots * kNComponents, std::numeric_limits<float>::quiet_NaN());
+  m_key(lepton) = m_currentKey;
+}
+
+float* LeptonSFCache::Values(const SG::AuxElement& lepton, unsigned int slot){
+  if (slot >= m_nSlots) return 0;
+  if (!m_key.isAvailable(lepton) || m_key(lepton) != m_currentKey) return 0;
+  return &m_values(lepton)[slot * kNComponents];
+}
+
+std::string LeptonSFCache::Summary() const {
+  char summary[128];
+  snprintf(summary, sizeof(summary), "%lu tool evaluations, %lu cached reads", m_evaluations, m_reads);
+  return summary;
+}
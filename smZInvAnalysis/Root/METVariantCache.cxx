@@ -0,0 +1,38 @@
+#include <smZInvAnalysis/METVariantCache.h>
+
+#include <sstream>
+
+METVariantCache::METVariantCache() :
+  m_nStored(0),
+  m_nBuilds(0),
+  m_nHits(0)
+{
+  for (unsigned int i = 0; i < kNDefinitions; i++) m_valid[i] = false;
+}
+
+const METVariantCache::Variant* METVariantCache::Store(unsigned int definition, const xAOD::MissingET& final){
+  Variant& variant = m_variants[definition];
+  variant.met = final.met();
+  variant.phi = final.phi();
+  variant.mpx = final.mpx();
+  variant.mpy = final.mpy();
+  if (!m_valid[definition]) {
+    m_valid[definition] = true;
+    m_stored[m_nStored++] = definition;
+  }
+  m_nBuilds++;
+  return &variant;
+}
+
+void METVariantCache::Reset(){
+  // only a handful of definitions are used per event
+  for (unsigned int i = 0; i < m_nStored; i++) m_valid[m_stored[i]] = false;
+  m_nStored = 0;
+}
+
+std::string METVariantCache::Summary() const {
+
+  std::ostringstream out;
+  out << m_nBuilds << " MET rebuilds, " << m_nHits << " taken from the cache";
+  return out.str();
+}
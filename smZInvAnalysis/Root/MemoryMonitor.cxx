@@ -0,0 +1,162 @@
+#include <smZInvAnalysis/MemoryMonitor.h>
+
+#include <cstdio>
+#include <sstream>
+
+#ifdef __linux__
+#include <malloc.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+  // RSS in kB (second field of /proc/self/statm, in pages); 0 where there is no /proc
+  double residentKB(){
+#ifdef __linux__
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (!statm) return 0.;
+    unsigned long size = 0, resident = 0;
+    int n = fscanf(statm, "%lu %lu", &size, &resident);
+    fclose(statm);
+    if (n != 2) return 0.;
+    return resident * (sysconf(_SC_PAGESIZE) / 1024.);
+#else
+    return 0.;
+#endif
+  }
+
+  // heap in use in kB (small blocks and mmapped ones); mallinfo() has int fields that wrap above 2 GB
+  double heapKB(){
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return (info.uordblks + info.hblkhd) / 1024.;
+#elif defined(__GLIBC__)
+    struct mallinfo info = mallinfo();
+    return ((unsigned int)info.uordblks + (unsigned int)info.hblkhd) / 1024.;
+#else
+    return 0.;
+#endif
+  }
+
+  // timeline bins before the first extension of the axis
+  const int kTimelineBins = 100;
+
+}
+
+MemoryMonitor::Usage MemoryMonitor::Current(){
+  Usage usage = { residentKB(), heapKB() };
+  return usage;
+}
+
+MemoryMonitor::MemoryMonitor(EL::Worker* wk, StageTimer* timer, unsigned int interval, double warningKBPerEvent) :
+  m_timer(timer),
+  m_interval(interval),
+  m_warningKBPerEvent(warningKBPerEvent),
+  m_nEvents(0),
+  m_nSamples(0),
+  m_sampling(false),
+  m_previousEvent(0),
+  m_lastEvent(0)
+{
+  m_first = m_previous = m_last = Current();
+  for (int i = 0; i < StageTimer::kNStages; i++) {
+    m_stageRss[i] = 0.;
+    m_stageHeap[i] = 0.;
+    m_stageCalls[i] = 0;
+  }
+
+  // the event axis doubles when it is exceeded; profiles average the samples merged into a bin
+  m_rssHist = new TProfile("memory_rss", "Resident set size;event;MB", kTimelineBins, 0., double(kTimelineBins) * interval);
+  m_heapHist = new TProfile("memory_heap", "Heap in use;event;MB", kTimelineBins, 0., double(kTimelineBins) * interval);
+  m_rssHist->SetCanExtend(TH1::kXaxis);
+  m_heapHist->SetCanExtend(TH1::kXaxis);
+
+  const int nStages = StageTimer::kNStages;
+  m_stageRssHist = new TH1D("memory_stage_rss", "RSS growth per stage (sampled events);;kB", nStages, -0.5, nStages - 0.5);
+  m_stageHeapHist = new TH1D("memory_stage_heap", "Heap growth per stage (sampled events);;kB", nStages, -0.5, nStages - 0.5);
+  m_stageCallsHist = new TH1D("memory_stage_calls", "Sampled calls per stage;;calls", nStages, -0.5, nStages - 0.5);
+  for (int i = 0; i < nStages; i++) {
+    const char* name = StageTimer::StageName(StageTimer::Stage(i));
+    m_stageRssHist->GetXaxis()->SetBinLabel(i + 1, name);
+    m_stageHeapHist->GetXaxis()->SetBinLabel(i + 1, name);
+    m_stageCallsHist->GetXaxis()->SetBinLabel(i + 1, name);
+  }
+
+  wk->addOutput(m_rssHist);
+  wk->addOutput(m_heapHist);
+  wk->addOutput(m_stageRssHist);
+  wk->addOutput(m_stageHeapHist);
+  wk->addOutput(m_stageCallsHist);
+
+  m_timer->SetMemoryMonitor(this);
+}
+
+MemoryMonitor::~MemoryMonitor(){
+  m_timer->SetMemoryMonitor(0);
+  m_timer->SetSamplingMemory(false);
+}
+
+bool MemoryMonitor::BeginEvent(){
+  unsigned long event = m_nEvents++;
+  m_sampling = (event % m_interval == 0);
+  m_timer->SetSamplingMemory(m_sampling);
+  if (!m_sampling) return false;
+
+  m_previous = m_last;
+  m_previousEvent = m_lastEvent;
+  m_last = Current();
+  m_lastEvent = event;
+  if (m_nSamples == 0) m_first = m_last;
+  m_nSamples++;
+
+  m_rssHist->Fill(event, m_last.rss / 1024.);
+  m_heapHist->Fill(event, m_last.heap / 1024.);
+
+  // samples 0 and 1 bound the warm-up interval
+  if (m_nSamples < 3) return false;
+  return (m_last.rss - m_previous.rss) / (m_lastEvent - m_previousEvent) > m_warningKBPerEvent;
+}
+
+void MemoryMonitor::AddStage(StageTimer::Stage stage, const Usage& start, const Usage& end){
+  m_stageRss[stage] += end.rss - start.rss;
+  m_stageHeap[stage] += end.heap - start.heap;
+  m_stageCalls[stage]++;
+}
+
+std::string MemoryMonitor::GrowthReport() const {
+  unsigned long nEvents = m_lastEvent > m_previousEvent ? m_lastEvent - m_previousEvent : 1;
+  char report[256];
+  snprintf(report, sizeof(report), "RSS grew by %.1f kB/event over events %lu-%lu (heap %+.1f kB/event), now %.1f MB",
+      (m_last.rss - m_previous.rss) / nEvents, m_previousEvent, m_lastEvent, (m_last.heap - m_previous.heap) / nEvents, m_last.rss / 1024.);
+  return report;
+}
+
+void MemoryMonitor::Finalize(){
+  for (int i = 0; i < StageTimer::kNStages; i++) {
+    m_stageRssHist->SetBinContent(i + 1, m_stageRss[i]);
+    m_stageHeapHist->SetBinContent(i + 1, m_stageHeap[i]);
+    m_stageCallsHist->SetBinContent(i + 1, m_stageCalls[i]);
+  }
+  // the bins are sums, so that hadd adds them; keep the entries consistent with that
+  m_stageRssHist->SetEntries(m_nSamples);
+  m_stageHeapHist->SetEntries(m_nSamples);
+  m_stageCallsHist->SetEntries(m_nSamples);
+}
+
+std::string MemoryMonitor::Summary() const {
+
+  std::ostringstream out;
+  char line[160];
+  unsigned long nEvents = m_lastEvent > 0 ? m_lastEvent : 1;
+  snprintf(line, sizeof(line), "\n  RSS %.1f MB at event 0, %.1f MB at event %lu (%+.2f kB/event); heap %.1f MB, %.1f MB (%+.2f kB/event)",
+      m_first.rss / 1024., m_last.rss / 1024., m_lastEvent, (m_last.rss - m_first.rss) / nEvents,
+      m_first.heap / 1024., m_last.heap / 1024., (m_last.heap - m_first.heap) / nEvents);
+  out << line;
+  for (int i = 0; i < StageTimer::kNStages; i++) {
+    if (m_stageCalls[i] == 0) continue;
+    snprintf(line, sizeof(line), "\n  %-20s RSS %+10.1f kB heap %+10.1f kB %8lu sampled calls %+8.2f kB heap/call",
+        StageTimer::StageName(StageTimer::Stage(i)), m_stageRss[i], m_stageHeap[i], m_stageCalls[i], m_stageHeap[i] / m_stageCalls[i]);
+    out << line;
+  }
+  return out.str();
+}
@@ -0,0 +1,144 @@
+#include <smZInvAnalysis/MetTrigSFTable.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+  const char* const channelNames[MetTrigSFTable::kNChannels] = { "znunu", "zmumu", "zee", "wmunu", "wenu" };
+  const char* const jetCutNames[MetTrigSFTable::kNJetCuts] = { "exclusive", "inclusive" };
+
+  int indexOf(const char* const* names, int n, const std::string& name){
+    for (int i = 0; i < n; i++) if (name == names[i]) return i;
+    return -1;
+  }
+}
+
+MetTrigSFTable::MetTrigSFTable(){
+}
+
+bool MetTrigSFTable::Load(const std::string& path){
+
+  std::ifstream in(path.c_str());
+  if (!in) {
+    std::cerr << "MetTrigSFTable: cannot read " << path << std::endl;
+    return false;
+  }
+
+  struct SFLine {
+    std::string period;
+    int channel;
+    int jetCut;
+    Table table;
+    unsigned int lineNumber;
+  };
+  std::vector<SFLine> sfLines;
+  m_periods.clear();
+
+  std::string line;
+  unsigned int lineNumber = 0;
+  while (std::getline(in, line)) {
+    lineNumber++;
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream ss(line);
+    std::string keyword;
+    if (!(ss >> keyword)) continue;
+
+    if (keyword == "period") {
+      RunRange range;
+      if (!(ss >> range.name >> range.firstRun >> range.lastRun) || range.lastRun < range.firstRun) {
+        std::cerr << "MetTrigSFTable: malformed period at line " << lineNumber << " in " << path << std::endl;
+        return false;
+      }
+      m_periods.push_back(range);
+    }
+    else if (keyword == "sf") {
+      SFLine sfLine;
+      sfLine.lineNumber = lineNumber;
+      std::string channel, jetCut, token;
+      ss >> sfLine.period >> channel >> jetCut;
+      sfLine.channel = indexOf(channelNames, kNChannels, channel);
+      sfLine.jetCut = indexOf(jetCutNames, kNJetCuts, jetCut);
+      bool afterBar = false;
+      while (ss >> token) {
+        if (token == "|") { afterBar = true; continue; }
+        float value = std::atof(token.c_str());
+        if (afterBar) sfLine.table.sf.push_back(value);
+        else sfLine.table.edges.push_back(value * 1000.); // GeV -> MeV
+      }
+      const Table& t = sfLine.table;
+      if (sfLine.channel < 0 || sfLine.jetCut < 0 || t.edges.size() < 2 || t.sf.size() + 1 != t.edges.size() ||
+          !std::is_sorted(t.edges.begin(), t.edges.end())) {
+        std::cerr << "MetTrigSFTable: malformed sf at line " << lineNumber << " in " << path << std::endl;
+        return false;
+      }
+      sfLines.push_back(sfLine);
+    }
+    else {
+      std::cerr << "MetTrigSFTable: unknown keyword '" << keyword << "' at line " << lineNumber << " in " << path << std::endl;
+      return false;
+    }
+  }
+
+  std::sort(m_periods.begin(), m_periods.end(), [](const RunRange& a, const RunRange& b) { return a.firstRun < b.firstRun; });
+  for (unsigned int i = 1; i < m_periods.size(); i++) {
+    if (m_periods[i].firstRun <= m_periods[i-1].lastRun) {
+      std::cerr << "MetTrigSFTable: periods " << m_periods[i-1].name << " and " << m_periods[i].name << " overlap in " << path << std::endl;
+      return false;
+    }
+    for (unsigned int j = 0; j < i; j++) {
+      if (m_periods[j].name == m_periods[i].name) {
+        std::cerr << "MetTrigSFTable: period " << m_periods[i].name << " is defined twice in " << path << std::endl;
+        return false;
+      }
+    }
+  }
+
+  m_tables.assign(m_periods.size() * kNChannels * kNJetCuts, Table());
+  for (const auto& sfLine : sfLines) {
+    int period = -1;
+    for (unsigned int i = 0; i < m_periods.size(); i++) if (m_periods[i].name == sfLine.period) period = i;
+    if (period < 0) {
+      std::cerr << "MetTrigSFTable: unknown period '" << sfLine.period << "' in " << path << std::endl;
+      return false;
+    }
+    // a repeated key would silently replace the earlier SFs
+    Table& table = m_tables[(period * kNChannels + sfLine.channel) * kNJetCuts + sfLine.jetCut];
+    if (!table.edges.empty()) {
+      std::cerr << "MetTrigSFTable: sf at line " << sfLine.lineNumber << " repeats " << sfLine.period << " " << channelNames[sfLine.channel]
+        << " " << jetCutNames[sfLine.jetCut] << " in " << path << std::endl;
+      return false;
+    }
+    table = sfLine.table;
+  }
+
+  return true;
+}
+
+int MetTrigSFTable::Period(unsigned int runNumber) const {
+  // first period starting after runNumber; the candidate is the one before it
+  auto it = std::upper_bound(m_periods.begin(), m_periods.end(), runNumber,
+      [](unsigned int run, const RunRange& range) { return run < range.firstRun; });
+  if (it == m_periods.begin()) return -1;
+  --it;
+  if (runNumber > it->lastRun) return -1;
+  return it - m_periods.begin();
+}
+
+float MetTrigSFTable::Evaluate(const Table& table, float met){
+  const std::vector<float>& edges = table.edges;
+  if (edges.empty() || met <= edges.front() || met >= edges.back()) return 1.;
+  std::size_t bin = std::upper_bound(edges.begin(), edges.end(), met) - edges.begin() - 1;
+  return table.sf[bin];
+}
+
+std::string MetTrigSFTable::Summary() const {
+
+  unsigned int nTables = 0;
+  for (const auto& table : m_tables) if (!table.edges.empty()) nTables++;
+  std::ostringstream out;
+  out << m_periods.size() << " trigger periods, " << nTables << " SF tables";
+  return out.str();
+}
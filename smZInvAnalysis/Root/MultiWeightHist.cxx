@@ -0,0 +1,127 @@
+#include <smZInvAnalysis/MultiWeightHist.h>
+
+#include <TArrayD.h>
+
+#include <algorithm>
+#include <iostream>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+  // sum[i] += w[i] and sum2[i] += w[i]*w[i] for i in [0, n); SSE2 is part of x86-64, so no dispatch is needed
+  inline void addWeights(double* sum, double* sum2, const double* w, unsigned int n){
+    unsigned int i = 0;
+#ifdef __SSE2__
+    for (; i + 2 <= n; i += 2) {
+      __m128d wi = _mm_loadu_pd(w + i);
+      _mm_storeu_pd(sum + i, _mm_add_pd(_mm_loadu_pd(sum + i), wi));
+      _mm_storeu_pd(sum2 + i, _mm_add_pd(_mm_loadu_pd(sum2 + i), _mm_mul_pd(wi, wi)));
+    }
+#endif
+    for (; i < n; i++) {
+      sum[i] += w[i];
+      sum2[i] += w[i] * w[i];
+    }
+  }
+
+  // sumx[i] += w[i]*x and sumx2[i] += w[i]*x*x, evaluated as in TH1::Fill
+  inline void addMoments(double* sumx, double* sumx2, const double* w, double x, unsigned int n){
+    unsigned int i = 0;
+#ifdef __SSE2__
+    const __m128d xx = _mm_set1_pd(x);
+    for (; i + 2 <= n; i += 2) {
+      __m128d wx = _mm_mul_pd(_mm_loadu_pd(w + i), xx);
+      _mm_storeu_pd(sumx + i, _mm_add_pd(_mm_loadu_pd(sumx + i), wx));
+      _mm_storeu_pd(sumx2 + i, _mm_add_pd(_mm_loadu_pd(sumx2 + i), _mm_mul_pd(wx, xx)));
+    }
+#endif
+    for (; i < n; i++) {
+      sumx[i] += w[i] * x;
+      sumx2[i] += w[i] * x * x;
+    }
+  }
+
+  bool sameBinning(const TAxis* a, const TAxis* b){
+    if (a->GetNbins() != b->GetNbins() || a->GetXmin() != b->GetXmin() || a->GetXmax() != b->GetXmax()) return false;
+    const TArrayD* binsA = a->GetXbins();
+    const TArrayD* binsB = b->GetXbins();
+    if (binsA->GetSize() != binsB->GetSize()) return false;
+    for (int i = 0; i < binsA->GetSize(); i++)
+      if (binsA->GetAt(i) != binsB->GetAt(i)) return false;
+    return true;
+  }
+
+}
+
+MultiWeightHist::MultiWeightHist(const std::vector<TH1*>& hists) :
+  m_hists(hists),
+  m_axis(hists[0]->GetXaxis()),
+  m_merged(true),
+  m_nWeights(hists.size()),
+  m_nBins(hists[0]->GetXaxis()->GetNbins()),
+  m_nFills(0)
+{
+  for (TH1* h : m_hists) {
+    if (h->GetDimension() != 1 || !sameBinning(m_axis, h->GetXaxis())) {
+      std::cerr << "MultiWeightHist: " << h->GetName() << " does not have the binning of " << m_hists[0]->GetName()
+        << ", its weights are filled one by one" << std::endl;
+      m_merged = false;
+    }
+  }
+  if (m_merged) {
+    m_sumW.assign((m_nBins + 2) * m_nWeights, 0.);
+    m_sumW2.assign((m_nBins + 2) * m_nWeights, 0.);
+    m_stats.assign(4 * m_nWeights, 0.);
+  }
+}
+
+MultiWeightHist::~MultiWeightHist(){
+}
+
+void MultiWeightHist::Fill(double x, const double* w){
+  if (!m_merged) {
+    for (unsigned int i = 0; i < m_nWeights; i++) m_hists[i]->Fill(x, w[i]);
+    return;
+  }
+
+  int bin = m_axis->FindFixBin(x);
+  addWeights(&m_sumW[bin * m_nWeights], &m_sumW2[bin * m_nWeights], w, m_nWeights);
+  // under/overflow count in the entries but not in the statistics, as in TH1::Fill
+  if (bin >= 1 && bin <= m_nBins) {
+    addWeights(&m_stats[0], &m_stats[m_nWeights], w, m_nWeights);
+    addMoments(&m_stats[2 * m_nWeights], &m_stats[3 * m_nWeights], w, x, m_nWeights);
+  }
+  m_nFills++;
+}
+
+void MultiWeightHist::Flush(){
+  if (!m_merged || m_nFills == 0) return;
+
+  for (unsigned int i = 0; i < m_nWeights; i++) {
+    TH1* h = m_hists[i];
+    // statistics first: GetStats() recomputes them from the bin contents when the sum of weights is 0
+    double stats[TH1::kNstat] = {0};
+    h->GetStats(stats);
+    for (int k = 0; k < 4; k++) stats[k] += m_stats[k * m_nWeights + i];
+
+    if (!h->GetSumw2N()) h->Sumw2();
+    double* sumw2 = h->GetSumw2()->GetArray();
+    for (int bin = 0; bin < m_nBins + 2; bin++) {
+      const unsigned int index = bin * m_nWeights + i;
+      if (m_sumW2[index] == 0.) continue; // bin never filled with a non-zero weight
+      h->AddBinContent(bin, m_sumW[index]);
+      sumw2[bin] += m_sumW2[index];
+    }
+
+    h->PutStats(stats);
+    h->SetEntries(h->GetEntries() + m_nFills);
+  }
+
+  std::fill(m_sumW.begin(), m_sumW.end(), 0.);
+  std::fill(m_sumW2.begin(), m_sumW2.end(), 0.);
+  std::fill(m_stats.begin(), m_stats.end(), 0.);
+  m_nFills = 0;
+}
@@ -0,0 +1,91 @@
+#include <smZInvAnalysis/StageTimer.h>
+#include <smZInvAnalysis/MemoryMonitor.h>
+
+#include <cstdio>
+#include <sstream>
+
+const char* StageTimer::StageName(Stage stage){
+  static const char* const names[kNStages] = {
+    "execute",
+    "Event selection",
+    "Truth analysis",
+    "Truth dressing",
+    "Muons",
+    "Electrons",
+    "Photons",
+    "Taus",
+    "Jets",
+    "Overlap removal",
+    "MET rebuild",
+    "doZnunuExoticReco",
+    "doZmumuExoticReco",
+    "doZeeExoticReco",
+    "doZnunuSMReco",
+    "doZmumuSMReco",
+    "doZeeSMReco",
+    "doWmunuSMReco",
+    "doWenuSMReco",
+    "doZmumuTruth",
+    "doZllEmulTruth",
+    "doZnunuEmulTruth",
+  };
+  return names[stage];
+}
+
+StageTimer::StageTimer(EL::Worker* wk) :
+  m_memory(0),
+  m_samplingMemory(false)
+{
+  for (int i = 0; i < kNStages; i++) {
+    m_ticks[i] = 0;
+    m_calls[i] = 0;
+  }
+
+  m_timingHist = new TH1D("timing_hist", "Time per stage;;seconds", kNStages, -0.5, kNStages - 0.5);
+  m_callsHist = new TH1D("timing_calls", "Calls per stage;;calls", kNStages, -0.5, kNStages - 0.5);
+  for (int i = 0; i < kNStages; i++) {
+    m_timingHist->GetXaxis()->SetBinLabel(i + 1, StageName(Stage(i)));
+    m_callsHist->GetXaxis()->SetBinLabel(i + 1, StageName(Stage(i)));
+  }
+  wk->addOutput(m_timingHist);
+  wk->addOutput(m_callsHist);
+}
+
+double StageTimer::Seconds(int stage) const {
+  return std::chrono::duration<double>(std::chrono::steady_clock::duration(m_ticks[stage])).count();
+}
+
+void StageTimer::StartMemory(double* usage) const {
+  MemoryMonitor::Usage current = MemoryMonitor::Current();
+  usage[0] = current.rss;
+  usage[1] = current.heap;
+}
+
+void StageTimer::StopMemory(Stage stage, const double* start) const {
+  if (!m_memory) return;
+  MemoryMonitor::Usage begin = { start[0], start[1] };
+  m_memory->AddStage(stage, begin, MemoryMonitor::Current());
+}
+
+void StageTimer::Finalize(){
+  for (int i = 0; i < kNStages; i++) {
+    m_timingHist->SetBinContent(i + 1, Seconds(i));
+    m_callsHist->SetBinContent(i + 1, m_calls[i]);
+  }
+  // the bins are sums, so that hadd adds them; keep the entries consistent with that
+  m_timingHist->SetEntries(m_calls[kExecute]);
+  m_callsHist->SetEntries(m_calls[kExecute]);
+}
+
+std::string StageTimer::Summary() const {
+
+  std::ostringstream out;
+  char line[128];
+  for (int i = 0; i < kNStages; i++) {
+    if (m_calls[i] == 0) continue;
+    snprintf(line, sizeof(line), "\n  %-20s %10.3f s %10lu calls %10.1f us/call",
+        StageName(Stage(i)), Seconds(i), m_calls[i], 1e6 * Seconds(i) / m_calls[i]);
+    out << line;
+  }
+  return out.str();
+}
@@ -0,0 +1,84 @@
+#include <smZInvAnalysis/SystematicsPlan.h>
+
+#include <sstream>
+
+SystematicsPlan::SystematicsPlan()
+{
+}
+
+SystematicsPlan::~SystematicsPlan(){
+}
+
+void SystematicsPlan::RegisterTool(const CP::SystematicSet& affecting, unsigned int objects){
+  m_toolSys.push_back(affecting);
+  m_toolObjects.push_back(objects);
+}
+
+unsigned int SystematicsPlan::Classify(const CP::SystematicSet& sys) const {
+
+  unsigned int objects = kWeightOnly;
+  for (const auto& variation : sys) {
+    for (unsigned int i = 0; i < m_toolSys.size(); i++) {
+      // recommended variations are +-1 sigma points of continuous systematics
+      if (m_toolSys[i].matchSystematic(variation, CP::SystematicSet::FULLORCONTINUOUS)) objects |= m_toolObjects[i];
+    }
+  }
+  return objects;
+}
+
+void SystematicsPlan::Build(const std::vector<CP::SystematicSet>& sysList){
+
+  m_sys.clear();
+  m_affects.clear();
+
+  std::vector<CP::SystematicSet> weightOnly;
+  std::vector<CP::SystematicSet> kinematic;
+  std::vector<unsigned int> kinematicAffects;
+
+  for (const auto& sys : sysList) {
+    if (sys.name().empty()) {
+      m_sys.push_back(sys);
+      m_affects.push_back(kAllObjects);
+      continue;
+    }
+    unsigned int objects = Classify(sys);
+    if (objects == kWeightOnly) {
+      weightOnly.push_back(sys);
+    }
+    else {
+      kinematic.push_back(sys);
+      kinematicAffects.push_back(objects);
+    }
+  }
+
+  for (const auto& sys : weightOnly) {
+    m_sys.push_back(sys);
+    m_affects.push_back(kWeightOnly);
+  }
+  for (unsigned int i = 0; i < kinematic.size(); i++) {
+    m_sys.push_back(kinematic[i]);
+    m_affects.push_back(kinematicAffects[i]);
+  }
+}
+
+std::string SystematicsPlan::Summary() const {
+
+  unsigned int nWeightOnly = 0;
+  unsigned int nMuons = 0, nElectrons = 0, nPhotons = 0, nTaus = 0, nJets = 0, nMETSoft = 0;
+  for (unsigned int i = 0; i < m_sys.size(); i++) {
+    if (IsNominal(i)) continue;
+    if (m_affects[i] == kWeightOnly) nWeightOnly++;
+    if (m_affects[i] & kMuons) nMuons++;
+    if (m_affects[i] & kElectrons) nElectrons++;
+    if (m_affects[i] & kPhotons) nPhotons++;
+    if (m_affects[i] & kTaus) nTaus++;
+    if (m_affects[i] & kJets) nJets++;
+    if (m_affects[i] & kMETSoft) nMETSoft++;
+  }
+
+  std::ostringstream out;
+  out << m_sys.size() << " variations: " << nWeightOnly << " weight-only, rebuilding "
+      << nJets << " jets, " << nMuons << " muons, " << nElectrons << " electrons, "
+      << nPhotons << " photons, " << nTaus << " taus, " << nMETSoft << " MET soft term";
+  return out.str();
+}
@@ -0,0 +1,12 @@
+#include <smZInvAnalysis/ThresholdScan.h>
+
+#include <iostream>
+
+ThresholdScan::ThresholdScan(const float* thresholds, unsigned int n) :
+  m_thresholds(thresholds, thresholds + n)
+{
+  if (!std::is_sorted(m_thresholds.begin(), m_thresholds.end())) {
+    std::cerr << "ThresholdScan: thresholds are not in increasing order, sorting them" << std::endl;
+    std::sort(m_thresholds.begin(), m_thresholds.end());
+  }
+}
@@ -0,0 +1,189 @@
+#include <smZInvAnalysis/WeightVariationIndex.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+  const char kMagic[8] = {'S','M','Z','W','I','D','X','1'};
+  const std::size_t kHeaderSize = sizeof(kMagic) + 2*sizeof(uint32_t);
+}
+
+WeightVariationIndex::WeightVariationIndex() :
+  m_base(0), m_mapSize(0), m_entries(0), m_pool(0), m_nEntries(0), m_poolSize(0)
+{
+}
+
+WeightVariationIndex::~WeightVariationIndex(){
+  Close();
+}
+
+bool WeightVariationIndex::Open(const std::string& path){
+
+  Close();
+
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    std::cerr << "WeightVariationIndex: cannot open " << path << std::endl;
+    return false;
+  }
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || (std::size_t)st.st_size < kHeaderSize) {
+    std::cerr << "WeightVariationIndex: " << path << " is too short" << std::endl;
+    ::close(fd);
+    return false;
+  }
+
+  void* base = ::mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd); // the mapping stays valid after the descriptor is closed
+  if (base == MAP_FAILED) {
+    std::cerr << "WeightVariationIndex: mmap failed for " << path << std::endl;
+    return false;
+  }
+
+  const char* bytes = static_cast<const char*>(base);
+  uint32_t nEntries = 0;
+  uint32_t poolSize = 0;
+  std::memcpy(&nEntries, bytes + sizeof(kMagic), sizeof(uint32_t));
+  std::memcpy(&poolSize, bytes + sizeof(kMagic) + sizeof(uint32_t), sizeof(uint32_t));
+
+  std::size_t expected = kHeaderSize + (std::size_t)nEntries*sizeof(Entry) + poolSize;
+  if (std::memcmp(bytes, kMagic, sizeof(kMagic)) != 0 || (std::size_t)st.st_size != expected) {
+    std::cerr << "WeightVariationIndex: " << path << " is not a valid weight index" << std::endl;
+    ::munmap(base, st.st_size);
+    return false;
+  }
+
+  m_base = base;
+  m_mapSize = st.st_size;
+  m_nEntries = nEntries;
+  m_poolSize = poolSize;
+  m_entries = reinterpret_cast<const Entry*>(bytes + kHeaderSize);
+  m_pool = bytes + kHeaderSize + (std::size_t)nEntries*sizeof(Entry);
+
+  return true;
+}
+
+void WeightVariationIndex::Close(){
+  if (m_base) ::munmap(m_base, m_mapSize);
+  m_base = 0;
+  m_mapSize = 0;
+  m_entries = 0;
+  m_pool = 0;
+  m_nEntries = 0;
+  m_poolSize = 0;
+}
+
+int WeightVariationIndex::Compare(const Entry& e, uint32_t dsid, const char* name, std::size_t length) const {
+  if (e.dsid != dsid) return e.dsid < dsid ? -1 : 1;
+  std::size_t n = std::min<std::size_t>(e.nameLength, length);
+  int c = std::memcmp(m_pool + e.nameOffset, name, n);
+  if (c != 0) return c;
+  if (e.nameLength == length) return 0;
+  return e.nameLength < length ? -1 : 1;
+}
+
+int WeightVariationIndex::Find(uint32_t dsid, const char* weightName, int defaultIndex) const {
+
+  if (!m_entries) return defaultIndex;
+
+  std::size_t length = std::strlen(weightName);
+  std::size_t lo = 0;
+  std::size_t hi = m_nEntries;
+  while (lo < hi) {
+    std::size_t mid = lo + (hi - lo)/2;
+    int c = Compare(m_entries[mid], dsid, weightName, length);
+    if (c == 0) return m_entries[mid].index;
+    if (c < 0) lo = mid + 1;
+    else hi = mid;
+  }
+
+  return defaultIndex;
+}
+
+bool WeightVariationIndex::HasDsid(uint32_t dsid) const {
+  if (!m_entries) return false;
+  const Entry* end = m_entries + m_nEntries;
+  const Entry* it = std::lower_bound(m_entries, end, dsid,
+      [](const Entry& e, uint32_t d) { return e.dsid < d; });
+  return it != end && it->dsid == dsid;
+}
+
+bool WeightVariationIndex::Build(const std::string& txtPath, const std::string& idxPath){
+
+  std::ifstream in(txtPath.c_str());
+  if (!in) {
+    std::cerr << "WeightVariationIndex: cannot read " << txtPath << std::endl;
+    return false;
+  }
+
+  struct Row {
+    uint32_t dsid;
+    int32_t index;
+    std::string name;
+  };
+  std::vector<Row> rows;
+
+  std::string line;
+  unsigned int lineNumber = 0;
+  while (std::getline(in, line)) {
+    lineNumber++;
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream ss(line);
+    Row row;
+    if (!(ss >> row.dsid >> row.index)) {
+      std::cerr << "WeightVariationIndex: malformed line " << lineNumber << " in " << txtPath << std::endl;
+      return false;
+    }
+    std::getline(ss >> std::ws, row.name);
+    rows.push_back(row);
+  }
+
+  std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+      if (a.dsid != b.dsid) return a.dsid < b.dsid;
+      return a.name < b.name; // byte-wise, same ordering as Compare()
+  });
+
+  std::vector<Entry> entries;
+  std::string pool;
+  for (const auto& row : rows) {
+    if (!entries.empty() && entries.back().dsid == row.dsid &&
+        pool.compare(entries.back().nameOffset, entries.back().nameLength, row.name) == 0) {
+      std::cerr << "WeightVariationIndex: duplicate weight '" << row.name << "' for DSID " << row.dsid << std::endl;
+      return false;
+    }
+    Entry e;
+    e.dsid = row.dsid;
+    e.nameOffset = pool.size();
+    e.nameLength = row.name.size();
+    e.index = row.index;
+    entries.push_back(e);
+    pool += row.name;
+  }
+
+  std::ofstream out(idxPath.c_str(), std::ios::binary | std::ios::trunc);
+  if (!out) {
+    std::cerr << "WeightVariationIndex: cannot write " << idxPath << std::endl;
+    return false;
+  }
+  uint32_t nEntries = entries.size();
+  uint32_t poolSize = pool.size();
+  out.write(kMagic, sizeof(kMagic));
+  out.write(reinterpret_cast<const char*>(&nEntries), sizeof(nEntries));
+  out.write(reinterpret_cast<const char*>(&poolSize), sizeof(poolSize));
+  if (!entries.empty()) out.write(reinterpret_cast<const char*>(&entries[0]), entries.size()*sizeof(Entry));
+  out.write(pool.data(), pool.size());
+
+  return out.good();
+}
@@ -4,48 +4,109 @@
 #define BitsetCutflow_H
 
 #include <TH1I.h>
+#include <TH1D.h>
 #include <iostream>
-#include <map>
-#include <bitset>
+#include <string>
+#include <vector>
+#include <stdint.h>
 
 #include "EventLoop/Worker.h"
 
 using namespace std;
 
+/// Cutflows with step IDs fixed in initialize().
+///
+/// Every cutflow and every step is registered once, in initialize(), and the
+/// returned IDs are kept by the caller; in execute() Pass(cutflow, step) only
+/// sets a bit in a 64-bit word, so no string is built or looked up per event.
+/// PushBitSet() adds the bits of the cutflows touched in the event to plain
+/// counters (unweighted and weighted), which are copied into the output
+/// histograms in Finalize().
+///
+/// Cutflow "" is "cutflow_hist" (created by the constructor, ID 0), any other
+/// name N gives "cutflow_hist_N"; each also has a "..._weighted" version with
+/// the sum of weights. Bin 1 is "All" (every event), step s is bin s+1. As the
+/// bins are fixed by the registration order and not by the order in which the
+/// steps are first passed, the outputs of different jobs can be merged.
 class BitsetCutflow
 {
 
 public:
+	/// bit 0 is "All", so up to 63 steps per cutflow
+	static const unsigned int kMaxSteps = 64;
+	/// returned by AddStep() for a step that does not fit; it must not be passed to Pass()
+	static const unsigned int kInvalidStep = kMaxSteps;
+
 	BitsetCutflow(EL::Worker *wk);
 	~BitsetCutflow();
 
-	void FillCutflow(string cutflowStepName, bool fillCutflow = true);
-	void PrintCutflowLocally();
-        
+	/// Books the histograms of a new cutflow and returns its ID
+	unsigned int AddCutflow(const string& name);
+	/// Returns the ID of a new step (1..63) of cutflow; the same ID if label is already a step of it.
+	/// kInvalidStep if the cutflow has no room left (see NInvalidSteps())
+	unsigned int AddStep(unsigned int cutflow, const string& label);
+
+	/// Weight of every cutflow passed in this event unless given in Pass(); set it before the first Pass() of the event
+	void SetEventWeight(double weight) { m_eventWeight = weight; }
+
+	void Pass(unsigned int cutflow, unsigned int step) {
+		if (!m_bits[cutflow]) {
+			m_touched.push_back(cutflow);
+			m_weights[cutflow] = m_eventWeight;
+		}
+		m_bits[cutflow] |= uint64_t(1) << step;
+	}
+	/// e.g. per-systematic cutflows, whose event weight depends on the systematic
+	void Pass(unsigned int cutflow, unsigned int step, double weight) {
+		Pass(cutflow, step);
+		m_weights[cutflow] = weight;
+	}
+
 	/// WARNING call this function on the BEGIN of EVENT!!!
 	/// WARNING call this function in the finalize() function!!!
 	void PushBitSet();
-	bitset<99> getBitset(){
-      return m_bitset;
-    }
-    
+
+	/// copy the counters into the output histograms (call once, in finalize(), after the last PushBitSet())
+	void Finalize();
+
+	/// step label and number of events, one line per step
+	void PrintCutflowLocally(unsigned int cutflow = 0);
+
+	unsigned int NCutflows() const { return m_names.size(); }
+	/// steps that could not be registered; initialize() must fail if this is not 0
+	unsigned int NInvalidSteps() const { return m_nInvalidSteps; }
+
 private:
-	
-	unsigned int m_cutflowStepCounter; //!
-	
+
 	/// link to EventLoop worker;
 	EL::Worker *m_wk; //!
-	
-	/// actual bitset were we will store cutflow on event-by-event basis
-	bitset<99> m_bitset; //!
-	
-	/// map with cutflow steps
-	map<string,unsigned int> m_mapCutflowSteps; //!
-	
-	TH1I* m_cutflowHist; //!
-	
+
+	/// true once the first event has started, so that the first PushBitSet() does not count an event
+	bool m_eventOpen; //!
+	double m_eventWeight; //!
+	unsigned long m_nEvents; //!
+	double m_sumW; //!
+	double m_sumW2; //!
+	unsigned int m_nInvalidSteps; //!
+
+	/// per cutflow: bits passed in the current event, its weight, and the registered steps
+	vector<uint64_t> m_bits; //!
+	vector<double> m_weights; //!
+	vector<string> m_names; //!
+	vector<vector<string> > m_labels; //!
+	/// cutflows with at least one bit set in the current event
+	vector<unsigned int> m_touched; //!
+
+	/// per cutflow and step (index cutflow * kMaxSteps + step): events, sum of weights and of weights^2
+	vector<unsigned long> m_counts; //!
+	vector<double> m_sumWs; //!
+	vector<double> m_sumW2s; //!
+
+	vector<TH1I*> m_cutflowHists; //!
+	vector<TH1D*> m_weightedHists; //!
+
 	/// this is needed to distribute the algorithm to the workers
-	ClassDef(BitsetCutflow, 1);
+	ClassDef(BitsetCutflow, 2);
 
 };
 
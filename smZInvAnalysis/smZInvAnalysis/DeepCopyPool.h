@@ -0,0 +1,176 @@
+#ifndef DeepCopyPool_H
+#define DeepCopyPool_H
+
+#include "AthContainers/ConstDataVector.h"
+#include "AthContainers/DataVector.h"
+#include "xAODCore/AuxContainerBase.h"
+
+#include <map>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <vector>
+
+/// Per-event arena for deep-copy containers and their elements.
+///
+/// Containers handed out by Container() live for the whole job together with
+/// their AuxContainerBase, so the aux vectors keep their capacity from one
+/// event to the next. Elements come from a free list per type and are given
+/// back by Clear()/Reset() instead of being deleted, so that filling the
+/// containers in steady state does not go through malloc/free.
+///
+/// Selections that never modify their elements should use View() instead:
+/// a view only holds pointers to the input objects, so filling it copies no
+/// auxdata at all.
+///
+/// The pool owns everything it hands out: nothing taken from it may be
+/// recorded in a TStore or deleted by hand.
+class DeepCopyPool
+{
+
+public:
+	DeepCopyPool();
+	~DeepCopyPool();
+
+	/// empty container owned by the pool (replaces new CONT + new AuxContainerBase + setStore)
+	template <class CONT>
+	CONT* Container(const std::string& name);
+
+	/// empty view container (SG::VIEW_ELEMENTS) owned by the pool, for selections of input objects that are only read
+	template <class CONT>
+	ConstDataVector<CONT>* View(const std::string& name);
+
+	/// append a deep copy of obj, including all its auxdata, to cont
+	template <class T>
+	T* Copy(DataVector<T>* cont, const T& obj);
+
+	/// empty cont, giving its elements back to the free list
+	template <class T>
+	void Clear(DataVector<T>* cont);
+
+	/// empty every pooled container; called once at the start of each event
+	void Reset();
+
+	/// one-line summary of the pool size, e.g. for finalize()
+	std::string Summary() const;
+
+private:
+	class FreeListBase {
+	public:
+		virtual ~FreeListBase() {}
+		virtual unsigned long Allocated() const = 0;
+	};
+
+	template <class T>
+	class FreeList : public FreeListBase {
+	public:
+		FreeList() : m_allocated(0) {}
+		~FreeList() { for (auto elem : m_free) delete elem; }
+		T* Take() {
+			if (m_free.empty()) {
+				m_allocated++;
+				return new T();
+			}
+			T* elem = m_free.back();
+			m_free.pop_back();
+			return elem;
+		}
+		void Put(T* elem) {
+			// start the next event from a freshly constructed object (no cached state),
+			// reusing the memory of the old one
+			elem->~T();
+			new (elem) T();
+			m_free.push_back(elem);
+		}
+		unsigned long Allocated() const { return m_allocated; }
+	private:
+		std::vector<T*> m_free;
+		unsigned long m_allocated;
+	};
+
+	class SlotBase {
+	public:
+		virtual ~SlotBase() {}
+		virtual void Reset(DeepCopyPool& pool) = 0;
+	};
+
+	template <class CONT>
+	class Slot : public SlotBase {
+	public:
+		Slot() { m_cont.setStore( &m_aux ); } //< Connect the two
+		void Reset(DeepCopyPool& pool) { pool.Clear( &m_cont ); }
+		xAOD::AuxContainerBase m_aux; // declared first so that it outlives m_cont
+		CONT m_cont;
+	};
+
+	template <class CONT>
+	class ViewSlot : public SlotBase {
+	public:
+		ViewSlot() : m_view(SG::VIEW_ELEMENTS) {}
+		void Reset(DeepCopyPool&) { m_view.clear(); }
+		ConstDataVector<CONT> m_view;
+	};
+
+	template <class T>
+	FreeList<T>& GetFreeList();
+
+	std::map<std::string, SlotBase*> m_slots;
+	std::map<std::type_index, FreeListBase*> m_freeLists;
+
+};
+
+
+template <class CONT>
+CONT* DeepCopyPool::Container(const std::string& name)
+{
+	auto it = m_slots.find(name);
+	if (it == m_slots.end()) it = m_slots.insert(std::make_pair(name, (SlotBase*)new Slot<CONT>())).first;
+	Slot<CONT>* slot = dynamic_cast<Slot<CONT>*>(it->second);
+	if (!slot) throw std::logic_error("DeepCopyPool: container '" + name + "' requested with two different types");
+	Clear( &slot->m_cont );
+	return &slot->m_cont;
+}
+
+template <class CONT>
+ConstDataVector<CONT>* DeepCopyPool::View(const std::string& name)
+{
+	auto it = m_slots.find(name);
+	if (it == m_slots.end()) it = m_slots.insert(std::make_pair(name, (SlotBase*)new ViewSlot<CONT>())).first;
+	ViewSlot<CONT>* slot = dynamic_cast<ViewSlot<CONT>*>(it->second);
+	if (!slot) throw std::logic_error("DeepCopyPool: view '" + name + "' requested with two different types");
+	slot->m_view.clear();
+	return &slot->m_view;
+}
+
+template <class T>
+T* DeepCopyPool::Copy(DataVector<T>* cont, const T& obj)
+{
+	T* copied = GetFreeList<T>().Take();
+	cont->push_back( copied ); // copied acquires the container's auxstore
+	*copied = obj; // copies auxdata from one auxstore to the other
+	return copied;
+}
+
+template <class T>
+void DeepCopyPool::Clear(DataVector<T>* cont)
+{
+	FreeList<T>& freeList = GetFreeList<T>();
+	for (std::size_t i = 0; i < cont->size(); i++) {
+		T* elem = 0;
+		cont->swapElement(i, 0, elem); // released from the container without being deleted
+		if (elem) freeList.Put(elem);
+	}
+	cont->clear();
+}
+
+template <class T>
+DeepCopyPool::FreeList<T>& DeepCopyPool::GetFreeList()
+{
+	FreeListBase*& freeList = m_freeLists[std::type_index(typeid(T))];
+	if (!freeList) freeList = new FreeList<T>();
+	return *static_cast<FreeList<T>*>(freeList);
+}
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef EventSnapshot_H
+#define EventSnapshot_H
+
+#include "xAODJet/JetContainer.h"
+#include "xAODMuon/MuonContainer.h"
+#include "xAODEgamma/ElectronContainer.h"
+
+#include <smZInvAnalysis/FourMomentum.h>
+
+/// Kinematics of the selected objects of one systematic, as plain float arrays.
+///
+/// Filled once per systematic after overlap removal and the real MET, so the
+/// reco selections and plots that run many times per channel (the jet
+/// selections, passMonojet/passVBF, plotMonojet/plotVBF, the lepton
+/// preselections and the dilepton/W definitions) read contiguous arrays
+/// instead of going through the xAOD accessors and the jet cleaning tool on
+/// every call.
+///
+/// Every array of a collection starts on a 64-byte boundary and holds
+/// Padded(n) entries; the entries past n are zero, so loops may run over
+/// whole SIMD registers of kPadding floats.
+class EventSnapshot
+{
+
+public:
+	/// one collection, one array per variable
+	struct Objects {
+		unsigned int n;
+		float* pt;
+		float* eta;
+		float* phi;
+		float* m;
+		float* rapidity;
+		float* jvt; ///< jets only ("Jvt" decoration)
+		float* charge; ///< leptons only
+		unsigned char* bad; ///< jets only: reco jet failing the TightBad cleaning, set by the caller
+
+		/// object i as FourMomentum::Of() gives it for the xAOD object
+		FourMomentum P4(unsigned int i) const { return FourMomentum::PtEtaPhiM(pt[i], eta[i], phi[i], m[i]); }
+	};
+
+	/// array lengths are rounded up to a multiple of this (8 floats = one AVX register)
+	static const unsigned int kPadding = 8;
+	static unsigned int Padded(unsigned int n) { return (n + kPadding - 1) / kPadding * kPadding; }
+
+	EventSnapshot();
+	~EventSnapshot();
+
+	/// copy the kinematics of the good objects and the real MET of the current systematic
+	void Fill(const xAOD::JetContainer& jets, const xAOD::JetContainer& osJets,
+			const xAOD::MuonContainer& muons, const xAOD::ElectronContainer& electrons,
+			float met, float metPhi);
+
+	const Objects& Jets() const { return m_jets.objects; }
+	const Objects& OSJets() const { return m_osJets.objects; }
+	const Objects& Muons() const { return m_muons.objects; }
+	const Objects& Electrons() const { return m_electrons.objects; }
+	Objects& Jets() { return m_jets.objects; }
+	Objects& OSJets() { return m_osJets.objects; }
+
+	float Met() const { return m_met; }
+	float MetPhi() const { return m_metPhi; }
+
+private:
+	struct Block {
+		Block() : data(0), capacity(0) {}
+		Objects objects;
+		void* data;
+		unsigned int capacity;
+	};
+
+	/// make room for n objects (keeps the allocation if large enough) and zero the padding
+	static void Resize(Block& block, unsigned int n);
+	static void FillJets(Block& block, const xAOD::JetContainer& jets);
+	template <class CONT>
+	static void FillLeptons(Block& block, const CONT& leptons);
+
+	Block m_jets;
+	Block m_osJets;
+	Block m_muons;
+	Block m_electrons;
+	float m_met;
+	float m_metPhi;
+
+	EventSnapshot(const EventSnapshot&);
+	EventSnapshot& operator=(const EventSnapshot&);
+
+};
+
+#endif
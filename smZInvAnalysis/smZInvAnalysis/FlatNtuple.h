@@ -0,0 +1,90 @@
+#ifndef FlatNtuple_H
+#define FlatNtuple_H
+
+#include <TDirectory.h>
+#include <TTree.h>
+
+#include <string>
+
+/// One row of the flat ntuple: a selected reco-level event in one SM channel.
+///
+/// Only plain int/float scalars and fixed-size float arrays, so that the
+/// ntuple can be read column by column without any dictionary. Energies
+/// and momenta are in GeV.
+struct FlatNtupleRow {
+	static const int kMaxJets = 20;
+	static const int kMaxLeptons = 4;
+
+	int runNumber; ///< random run number for MC
+	ULong64_t eventNumber;
+	int channel; ///< FlatNtuple::Channel
+	int cutMask; ///< bits of FlatNtuple::Cut that the event passes
+
+	float weight; ///< MC event weight times pileup weight (1 for data)
+	float lepSF; ///< product of the lepton reco/ID/iso/TTVA/trigger SFs
+	float metTrigSF_exclusive;
+	float metTrigSF_inclusive;
+
+	float met; ///< MET of the channel (leptons marked invisible for Z->ll)
+	float met_phi;
+	float mll; ///< -1 if not a dilepton channel
+	float mT; ///< -1 if not a W channel
+	float mjj; ///< -1 with less than two jets
+
+	int nJet; ///< number of good jets, at most kMaxJets are stored
+	float jet_pt[kMaxJets];
+	float jet_eta[kMaxJets];
+	float jet_phi[kMaxJets];
+	float jet_m[kMaxJets];
+
+	int nLep; ///< number of good leptons of the channel flavour, at most kMaxLeptons are stored
+	float lep_pt[kMaxLeptons];
+	float lep_eta[kMaxLeptons];
+	float lep_phi[kMaxLeptons];
+	float lep_charge[kMaxLeptons];
+};
+
+/// Flat per-channel ntuple written next to the histograms.
+///
+/// The SM channel functions fill Row() once per selected event (nominal
+/// only, after the MET cut) and call Fill(). The remaining cuts are stored
+/// in cutMask so that the histograms can be remade from the ntuple with
+/// different binning or cuts. The tree is created in the given output
+/// directory, which owns it.
+class FlatNtuple
+{
+
+public:
+	enum Channel { kZnunu = 0, kZmumu, kZee, kWmunu, kWenu };
+	enum Cut {
+		kPassExclusiveJet = 0,
+		kPassInclusiveJet,
+		kPassMetTrigger,
+		kPassMuonTrigger,
+		kPassElectronTrigger,
+		kPassMllWindow,
+		kPassMT,
+	};
+
+	FlatNtuple(TDirectory* dir, const std::string& name);
+
+	/// run and event number of the current event, copied into every row
+	void SetEvent(int runNumber, ULong64_t eventNumber);
+
+	/// row buffer; reset by Fill()
+	FlatNtupleRow& Row() { return m_row; }
+	void Fill();
+
+	Long64_t Entries() const { return m_tree->GetEntries(); }
+
+private:
+	void Clear();
+
+	TTree* m_tree; //!
+	FlatNtupleRow m_row; //!
+	int m_runNumber; //!
+	ULong64_t m_eventNumber; //!
+
+};
+
+#endif
@@ -0,0 +1,160 @@
+#ifndef FourMomentum_H
+#define FourMomentum_H
+
+#include "xAODBase/IParticle.h"
+#include "xAODTruth/TruthParticle.h"
+
+#include <algorithm>
+#include <cmath>
+
+/// Plain 4-vector for the analysis-side kinematics (mll, mjj, jet - lepton subtraction, ...).
+///
+/// Replaces TLorentzVector inside execute() and the do* functions: no TObject,
+/// no virtual calls, trivially copyable. A vector made from (pt, eta, phi, m)
+/// keeps those and only computes (px, py, pz, E) when it is added to another
+/// one; sums are kept in (px, py, pz, E) and Pt()/Eta()/Phi()/M() are computed
+/// on first use and cached. Definitions follow TLorentzVector (M() < 0 for
+/// space-like vectors, Eta() = +-10e10 along the beam).
+///
+/// Of() is the boundary with xAOD: reco objects are taken from pt/eta/phi/m,
+/// truth particles from px/py/pz/e, as their p4() does.
+class FourMomentum
+{
+
+public:
+	constexpr FourMomentum() :
+		m_px(0.), m_py(0.), m_pz(0.), m_e(0.), m_pt(0.), m_eta(0.), m_phi(0.), m_m(0.), m_valid(kCartesian | kPolar) {}
+
+	static constexpr FourMomentum PxPyPzE(double px, double py, double pz, double e) {
+		return FourMomentum(px, py, pz, e, 0., 0., 0., 0., kCartesian);
+	}
+	static constexpr FourMomentum PtEtaPhiM(double pt, double eta, double phi, double m) {
+		return FourMomentum(0., 0., 0., 0., pt, eta, phi, m, kPolar);
+	}
+	/// e.g. the dressed lepton decorations (pt_dressed, eta_dressed, phi_dressed, e_dressed)
+	static FourMomentum PtEtaPhiE(double pt, double eta, double phi, double e) {
+		return PxPyPzE(pt * std::cos(phi), pt * std::sin(phi), pt * std::sinh(eta), e);
+	}
+
+	static FourMomentum Of(const xAOD::IParticle& particle) {
+		return PtEtaPhiM(particle.pt(), particle.eta(), particle.phi(), particle.m());
+	}
+	static FourMomentum Of(const xAOD::TruthParticle& particle) {
+		return PxPyPzE(particle.px(), particle.py(), particle.pz(), particle.e());
+	}
+
+	double Px() const { cartesian(); return m_px; }
+	double Py() const { cartesian(); return m_py; }
+	double Pz() const { cartesian(); return m_pz; }
+	double E() const { cartesian(); return m_e; }
+
+	double Pt() const { polar(); return m_pt; }
+	double Perp() const { return Pt(); }
+	double Eta() const { polar(); return m_eta; }
+	double Phi() const { polar(); return m_phi; }
+	double M() const { polar(); return m_m; }
+
+	double Rapidity() const { cartesian(); return 0.5 * std::log((m_e + m_pz) / (m_e - m_pz)); }
+
+	FourMomentum& operator+=(const FourMomentum& other) {
+		cartesian();
+		other.cartesian();
+		m_px += other.m_px;
+		m_py += other.m_py;
+		m_pz += other.m_pz;
+		m_e += other.m_e;
+		m_valid = kCartesian;
+		return *this;
+	}
+	FourMomentum& operator-=(const FourMomentum& other) {
+		cartesian();
+		other.cartesian();
+		m_px -= other.m_px;
+		m_py -= other.m_py;
+		m_pz -= other.m_pz;
+		m_e -= other.m_e;
+		m_valid = kCartesian;
+		return *this;
+	}
+	FourMomentum operator-() const {
+		cartesian();
+		return PxPyPzE(-m_px, -m_py, -m_pz, -m_e);
+	}
+
+	//----------------------------------
+	// mll, mjj and mT, also in batches
+	//----------------------------------
+
+	/// invariant mass of a + b (mll, mjj)
+	static double PairMass(const FourMomentum& a, const FourMomentum& b) {
+		FourMomentum sum = a;
+		sum += b;
+		return sum.M();
+	}
+	template <class PARTICLE>
+	static double PairMass(const PARTICLE& a, const PARTICLE& b) {
+		return PairMass(Of(a), Of(b));
+	}
+	/// invariant mass of the two leading objects of a container, 0 if it has fewer
+	template <class CONTAINER>
+	static double LeadingPairMass(const CONTAINER& objects) {
+		return objects.size() > 1 ? PairMass(*objects[0], *objects[1]) : 0.;
+	}
+	/// mass[i] = PairMass(a[i], b[i])
+	static void PairMasses(const FourMomentum* a, const FourMomentum* b, unsigned int n, float* mass) {
+		for (unsigned int i = 0; i < n; i++) mass[i] = PairMass(a[i], b[i]);
+	}
+
+	/// mT of a lepton and the MET
+	static double TransverseMass(double pt, double phi, double met, double metPhi) {
+		return std::sqrt(2. * pt * met * (1. - std::cos(phi - metPhi)));
+	}
+	/// mT[i] of lepton i and one MET
+	static void TransverseMasses(const float* pt, const float* phi, unsigned int n, float met, float metPhi, float* mT) {
+		for (unsigned int i = 0; i < n; i++) mT[i] = TransverseMass(pt[i], phi[i], met, metPhi);
+	}
+
+private:
+	enum Representation { kCartesian = 1 << 0, kPolar = 1 << 1 };
+
+	constexpr FourMomentum(double px, double py, double pz, double e, double pt, double eta, double phi, double m, unsigned char valid) :
+		m_px(px), m_py(py), m_pz(pz), m_e(e), m_pt(pt), m_eta(eta), m_phi(phi), m_m(m), m_valid(valid) {}
+
+	void cartesian() const {
+		if (m_valid & kCartesian) return;
+		m_px = m_pt * std::cos(m_phi);
+		m_py = m_pt * std::sin(m_phi);
+		m_pz = m_pt * std::sinh(m_eta);
+		double p2 = m_px*m_px + m_py*m_py + m_pz*m_pz;
+		m_e = m_m >= 0. ? std::sqrt(p2 + m_m*m_m) : std::sqrt(std::max(p2 - m_m*m_m, 0.));
+		m_valid |= kCartesian;
+	}
+
+	void polar() const {
+		if (m_valid & kPolar) return;
+		m_pt = std::sqrt(m_px*m_px + m_py*m_py);
+		m_phi = (m_px == 0. && m_py == 0.) ? 0. : std::atan2(m_py, m_px);
+		if (m_pt > 0.) m_eta = std::asinh(m_pz / m_pt);
+		else m_eta = m_pz == 0. ? 0. : (m_pz > 0. ? 10e10 : -10e10);
+		double m2 = m_e*m_e - m_px*m_px - m_py*m_py - m_pz*m_pz;
+		m_m = m2 < 0. ? -std::sqrt(-m2) : std::sqrt(m2);
+		m_valid |= kPolar;
+	}
+
+	// both representations are caches of each other; m_valid says which ones are filled
+	mutable double m_px;
+	mutable double m_py;
+	mutable double m_pz;
+	mutable double m_e;
+	mutable double m_pt;
+	mutable double m_eta;
+	mutable double m_phi;
+	mutable double m_m;
+	mutable unsigned char m_valid;
+
+};
+
+inline FourMomentum operator+(FourMomentum a, const FourMomentum& b) { return a += b; }
+inline FourMomentum operator-(FourMomentum a, const FourMomentum& b) { return a -= b; }
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef HistRegistry_H
+#define HistRegistry_H
+
+#include <TH1.h>
+#include <TH2.h>
+#include <THnSparse.h>
+
+#include "EventLoop/Worker.h"
+
+#include <smZInvAnalysis/MultiWeightHist.h>
+
+#include <stdint.h>
+#include <deque>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// Ordered list of histogram name templates filled by one function.
+///
+/// Placeholders are substituted when a block is resolved:
+///   {c} channel, {p} histogram prefix (level/selection), {s} systematic name,
+///   {w} scale-weight name: the slot of such a template is the handle of a
+///       weight group (its kNScaleWeights histograms) for FillWeights().
+struct HistTemplates {
+	const char* const* names;
+	unsigned int nNames;
+	unsigned int nSlots; ///< block size, one slot per template
+};
+
+/// Flat histogram store with integer handles.
+///
+/// addHist() registers every booked histogram here and gets back a handle,
+/// i.e. its position in a flat array. Fill functions resolve their templates
+/// once per (channel, prefix, systematic) context into a block of handles and
+/// then fill through hist[kVariable], so no key is built or looked up per fill.
+/// Histograms are owned by the EventLoop worker, not by the registry; the
+/// weight groups (MultiWeightHist) are owned by the registry and must be
+/// flushed into the histograms with Flush() before the outputs are written.
+///
+/// Book1D()/Book2D() create TH1F/TH2F and give them to the worker. After
+/// SetLazy(true) they only keep the binning, and a histogram is created on
+/// its first fill. Histograms never filled in a job (e.g. the muon
+/// systematics of a Zee sample) then take no memory and are not written.
+/// A 2D histogram can be booked sparse (THnSparseF, for the large unfolding
+/// matrices), which stores only the filled bins. MemorySummary() reports
+/// what was allocated.
+class HistRegistry
+{
+
+public:
+	/// scale-weight names in the order std::map<std::string, float> iterates them
+	static const int kNScaleWeights = 7;
+	static const char* ScaleWeightName(int i);
+	/// weights[i] = (scale weight i) * mcEventWeight / (NOMINAL scale weight) * sf, i.e. with the
+	/// PU weight of mcEventWeight; false if a scale weight is missing from mcWeights
+	static bool ScaledWeights(const std::map<std::string, float>& mcWeights, float mcEventWeight, float sf, double* weights);
+
+	/// histograms created by Book1D()/Book2D() are given to wk as outputs (kept by the caller, through Get(), if wk is 0)
+	HistRegistry(EL::Worker* wk = 0);
+	~HistRegistry();
+
+	/// histograms booked from now on are created on their first fill
+	void SetLazy(bool lazy) { m_lazy = lazy; }
+
+	/// book a histogram and return its handle
+	int Book1D(const std::string& name, int bins, double min, double max);
+	int Book1D(const std::string& name, int bins, const Float_t* edges);
+	int Book2D(const std::string& name, int binsX, double minX, double maxX, int binsY, double minY, double maxY);
+	int Book2D(const std::string& name, int binsX, const Float_t* edgesX, int binsY, const Float_t* edgesY, bool sparse = false);
+
+	/// register a histogram created by the caller and return its handle
+	int Add(TH1* h);
+	int Add(TH2* h);
+
+	/// handle of a booked histogram by name, or -1 (booking time only)
+	int Find(const std::string& name) const;
+	unsigned int Size() const { return m_hists.size(); }
+	/// 0 for a sparse histogram or one not created yet
+	TH1* Get(int handle) const { return handle >= 0 ? m_hists[handle] : 0; }
+
+	/// resolve templates for one context; the returned array stays valid for
+	/// the lifetime of the registry and repeated calls return the cached block
+	const int* Block(const HistTemplates& templates, const std::string& channel,
+			const std::string& prefix, const std::string& sysName);
+
+	/// fill by handle; a handle of -1 (histogram not booked) is counted and skipped
+	void Fill1D(int handle, double x, double w) {
+		if (handle >= 0 && m_hists[handle]) m_hists[handle]->Fill(x, w);
+		else FillSlow1D(handle, x, w);
+	}
+	void Fill2D(int handle, double x, double y, double w) {
+		if (handle >= 0 && m_hists2D[handle]) m_hists2D[handle]->Fill(x, y, w);
+		else FillSlow2D(handle, x, y, w);
+	}
+	/// fill a weight group ({w} slot) with w[0 .. kNScaleWeights-1], in ScaleWeightName() order
+	void FillWeights(int group, double x, const double* w) {
+		if (group >= 0 && m_groups[group]) m_groups[group]->Fill(x, w);
+		else FillSlowWeights(group, x, w);
+	}
+
+	/// threshold scan (see ThresholdScan): fill handles[i] for each of the nPassed thresholds passed
+	void FillScan1D(const int* handles, unsigned int nPassed, double x, double w) {
+		for (unsigned int i = 0; i < nPassed; i++) Fill1D(handles[i], x, w);
+	}
+	/// threshold scan in one 2D histogram whose x bin [i, i+1) is threshold i
+	void FillScan2D(int handle, unsigned int nPassed, double y, double w) {
+		for (unsigned int i = 0; i < nPassed; i++) Fill2D(handle, i + 0.5, y, w);
+	}
+
+	/// add the weight groups to their histograms; call before the outputs are written
+	void Flush();
+
+	/// number of fills that were dropped because the histogram was not booked
+	unsigned long MissedFills() const { return m_missedFills; }
+	unsigned int NumBlocks() const { return m_blocks.size(); }
+	unsigned int NumGroups() const { return m_groups.size(); }
+	/// booked histograms not created yet (lazy booking: never filled, so not written)
+	unsigned int NumPending() const { return m_pending.size(); }
+
+	/// histograms created and the memory of their bins against booking all of them dense, e.g. for finalize()
+	std::string MemorySummary() const;
+
+private:
+	struct BlockKey {
+		const HistTemplates* templates;
+		std::string channel;
+		std::string prefix;
+		std::string sysName;
+	};
+
+	/// binning of a booked histogram; binsY is 0 for 1D, edges are empty for fixed-width bins
+	struct Spec {
+		std::string name;
+		int binsX, binsY;
+		double minX, maxX, minY, maxY;
+		std::vector<double> edgesX, edgesY;
+		bool sparse;
+	};
+
+	int Register(TH1* h, TH2* h2);
+	int Book(const Spec& spec);
+	void Create(int handle);
+	void FillSlow1D(int handle, double x, double w);
+	void FillSlow2D(int handle, double x, double y, double w);
+	void FillSlowWeights(int group, double x, const double* w);
+	std::string Expand(const char* name, const std::string& channel, const std::string& prefix,
+			const std::string& sysName, int weight) const;
+	int Group(const char* name, const std::string& channel, const std::string& prefix, const std::string& sysName);
+
+	std::vector<TH1*> m_hists; //!
+	std::vector<TH2*> m_hists2D; //! same indexing as m_hists, 0 for 1D histograms
+	std::vector<THnSparse*> m_sparse; //! same indexing, 0 unless booked sparse (m_hists is 0 then)
+	std::unordered_map<int, Spec> m_pending; //! booked, created on first fill
+	std::unordered_map<std::string, int> m_index; //!
+
+	std::deque<std::vector<int> > m_blocks; //! deque keeps block addresses stable
+	std::vector<BlockKey> m_blockKeys; //!
+	std::unordered_multimap<uint64_t, unsigned int> m_blockIndex; //!
+
+	std::vector<MultiWeightHist*> m_groups; //! 0 until the first fill of the group
+	std::vector<std::vector<int> > m_groupHandles; //!
+	std::unordered_map<int, int> m_groupIndex; //! handle of the first histogram -> group
+
+	EL::Worker* m_wk; //!
+	bool m_lazy; //!
+	unsigned long m_missedFills; //!
+
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef KinematicKernels_H
+#define KinematicKernels_H
+
+/// deltaPhi/deltaR over whole object arrays (eta and phi as float arrays).
+///
+/// Same definitions as smZInvAnalysis::deltaPhi and deltaR (|dPhi| folded
+/// into [0, pi]), evaluated 8 (AVX2) or 4 (SSE2) objects at a time. The
+/// implementation is chosen once, on first use, from the CPU the job runs
+/// on; the scalar one is used on other architectures. Arrays need no
+/// alignment or padding, the last n % width objects are done one by one.
+class KinematicKernels
+{
+
+public:
+	enum Implementation { kScalar = 0, kSSE2, kAVX2, kNImplementations };
+
+	/// min over i of deltaPhi(phi[i], phiRef); 9 if n == 0 (no jet passes a dPhi cut then)
+	static float MinDeltaPhi(const float* phi, unsigned int n, float phiRef) {
+		return Get().minDeltaPhi(phi, n, phiRef);
+	}
+
+	/// dRmin[i] = min over j of deltaR(object i of 1, object j of 2); 9 if n2 == 0
+	static void MinDeltaR(const float* eta1, const float* phi1, unsigned int n1,
+			const float* eta2, const float* phi2, unsigned int n2, float* dRmin) {
+		Get().minDeltaR(eta1, phi1, n1, eta2, phi2, n2, dRmin);
+	}
+
+	/// all pairs: dR[i*n2 + j] = deltaR(object i of 1, object j of 2)
+	static void DeltaR(const float* eta1, const float* phi1, unsigned int n1,
+			const float* eta2, const float* phi2, unsigned int n2, float* dR) {
+		Get().deltaR(eta1, phi1, n1, eta2, phi2, n2, dR);
+	}
+
+	/// the implementation in use
+	static Implementation Selected();
+	/// best implementation this CPU supports
+	static Implementation Best();
+	/// force an implementation (e.g. for comparisons); false if this CPU does not support it
+	static bool Select(Implementation implementation);
+	static const char* Name(Implementation implementation);
+
+private:
+	struct Functions {
+		float (*minDeltaPhi)(const float*, unsigned int, float);
+		void (*minDeltaR)(const float*, const float*, unsigned int, const float*, const float*, unsigned int, float*);
+		void (*deltaR)(const float*, const float*, unsigned int, const float*, const float*, unsigned int, float*);
+		Implementation implementation;
+	};
+
+	static const Functions& Get() {
+		if (!s_functions) s_functions = &Table(Best());
+		return *s_functions;
+	}
+	static const Functions& Table(Implementation implementation);
+
+	static const Functions* s_functions;
+
+};
+
+#endif
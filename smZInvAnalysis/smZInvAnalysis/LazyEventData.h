@@ -0,0 +1,68 @@
+#ifndef LazyEventData_H
+#define LazyEventData_H
+
+#include "xAODRootAccess/TEvent.h"
+
+#include <map>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+
+/// Per-event cache of the input containers read from the TEvent.
+///
+/// A container is read from the file the first time Retrieve() asks for it
+/// in an event; later calls in the same event return the cached pointer.
+/// Containers that no selection asks for in an event are never read, so
+/// events rejected early (GRL, cleaning, vertex) do not pay for the reco and
+/// truth collections. Reset() must be called at the start of each event.
+class LazyEventData
+{
+
+public:
+	LazyEventData(xAOD::TEvent* event);
+
+	/// container with the given key, read on first access in the event;
+	/// returns false (and obj = 0) if the key is not in the input
+	template <class T>
+	bool Retrieve(const T*& obj, const std::string& key);
+
+	/// forget the cached pointers; called once at the start of each event
+	void Reset();
+
+	/// one line per key: number of events in which it was read, e.g. for finalize()
+	std::string Summary() const;
+
+private:
+	struct Entry {
+		Entry() : obj(0), type(typeid(void)), cached(false), nRead(0) {}
+		const void* obj;
+		std::type_index type;
+		bool cached;
+		unsigned long nRead;
+	};
+
+	xAOD::TEvent* m_event;
+	std::map<std::string, Entry> m_entries;
+	unsigned long m_nEvents;
+
+};
+
+
+template <class T>
+bool LazyEventData::Retrieve(const T*& obj, const std::string& key)
+{
+	Entry& entry = m_entries[key];
+	if (entry.cached && entry.type == std::type_index(typeid(T))) {
+		obj = static_cast<const T*>(entry.obj);
+		return obj != 0;
+	}
+	obj = 0;
+	if (!m_event->retrieve(obj, key).isSuccess()) obj = 0;
+	entry.obj = obj;
+	entry.type = std::type_index(typeid(T));
+	entry.cached = true;
+	if (obj) entry.nRead++;
+	return obj != 0;
+}
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef LeptonSFCache_H
+#define LeptonSFCache_H
+
+#include "AthContainers/AuxElement.h"
+
+#include <string>
+#include <vector>
+
+/// Lepton scale factors of the current systematic, cached as decorations
+/// of the selected leptons.
+///
+/// Each lepton gets kNComponents SFs (reco, id/iso, ... see MuonSF and
+/// ElectronSF) per slot: slot 0 is the systematic the leptons were selected
+/// with, slots 1.. are the weight-only systematics, which reuse the nominal
+/// leptons and so can be evaluated in the same pass. Values not evaluated
+/// yet are NaN. Begin() starts a new evaluation: the decorations of earlier
+/// events or systematics are no longer valid after it, so that leptons
+/// from a recycled container are never read.
+class LeptonSFCache
+{
+
+public:
+	enum MuonSF { kMuonReco = 0, kMuonIso, kMuonTTVA, kMuonTrig };
+	enum ElectronSF { kElectronReco = 0, kElectronId, kElectronIso, kElectronTrig };
+	static const unsigned int kNComponents = 4;
+
+	LeptonSFCache();
+
+	/// new evaluation with nSlots slots; the slot read by Current() is reset to 0
+	void Begin(unsigned int nSlots);
+	/// slot of the systematic being processed
+	void SetSlot(unsigned int slot) { m_slot = slot; }
+	unsigned int Slot() const { return m_slot; }
+
+	/// decorate lepton with nSlots x kNComponents NaN
+	void Add(const SG::AuxElement& lepton);
+
+	/// the kNComponents SFs of lepton in slot, 0 if lepton was not added in this evaluation or slot is out of range
+	float* Values(const SG::AuxElement& lepton, unsigned int slot);
+	float* Current(const SG::AuxElement& lepton) { return Values(lepton, m_slot); }
+
+	/// SF evaluations by the CP tools and reads served from the cache, e.g. for finalize()
+	void CountEvaluation() { m_evaluations++; }
+	void CountRead() { m_reads++; }
+	std::string Summary() const;
+
+private:
+	SG::AuxElement::Decorator<std::vector<float> > m_values; //!
+	SG::AuxElement::Decorator<unsigned int> m_key; //!
+
+	unsigned int m_currentKey; //!
+	unsigned int m_nSlots; //!
+	unsigned int m_slot; //!
+
+	unsigned long m_evaluations; //!
+	unsigned long m_reads; //!
+
+};
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef METVariantCache_H
+#define METVariantCache_H
+
+#include "xAODMissingET/MissingET.h"
+
+#include <string>
+
+/// "Final" MET of the variants rebuilt with METMaker, per event and systematic.
+///
+/// A variant is identified by its definition: the objects entering the
+/// rebuild as visible or invisible terms and whether the photon and tau terms
+/// are included. The do*Reco functions look their variant up before running
+/// METMaker and store it after building it, so each definition is rebuilt
+/// once per systematic instead of once per channel (e.g. the exclusive and
+/// inclusive calls of doZmumuSMReco, or doZeeSMReco and doZeeExoticReco).
+///
+/// Every definition must map to one fixed rebuild sequence on the current
+/// good-object containers. Reset() must be called whenever these change,
+/// i.e. for each variation that modifies objects.
+class METVariantCache
+{
+
+public:
+	/// Terms of a MET definition; a definition is an OR of these
+	enum Term {
+		kElectron = 1 << 0, ///< good electrons as visible RefEle term
+		kElectronInvisible = 1 << 1, ///< good electrons marked invisible
+		kMuon = 1 << 2, ///< good muons as visible Muons term
+		kMuonInvisible = 1 << 3, ///< good muons marked invisible
+		kMuonForZInvisible = 1 << 4, ///< good muons for Z marked invisible
+		kPhoton = 1 << 5, ///< good photons as RefGamma term
+		kTau = 1 << 6, ///< good taus as RefTau term
+		kNDefinitions = 1 << 7
+	};
+
+	struct Variant {
+		float met;
+		float phi;
+		float mpx;
+		float mpy;
+	};
+
+	METVariantCache();
+
+	/// variant with this definition, or 0 if it was not built since the last Reset()
+	const Variant* Find(unsigned int definition) {
+		if (m_valid[definition]) {
+			m_nHits++;
+			return &m_variants[definition];
+		}
+		return 0;
+	}
+
+	/// store the "Final" term just built for this definition
+	const Variant* Store(unsigned int definition, const xAOD::MissingET& final);
+
+	/// forget all variants; the good objects have changed
+	void Reset();
+
+	/// number of rebuilds and of rebuilds saved, e.g. for finalize()
+	std::string Summary() const;
+
+private:
+	Variant m_variants[kNDefinitions];
+	bool m_valid[kNDefinitions];
+	unsigned int m_stored[kNDefinitions]; ///< definitions valid since the last Reset()
+	unsigned int m_nStored;
+
+	unsigned long m_nBuilds;
+	unsigned long m_nHits;
+
+};
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef MemoryMonitor_H
+#define MemoryMonitor_H
+
+#include <TH1D.h>
+#include <TProfile.h>
+
+#include "EventLoop/Worker.h"
+
+#include <smZInvAnalysis/StageTimer.h>
+
+#include <string>
+
+/// Memory use of the job, sampled every N events, per worker.
+///
+/// On a sampled event the resident set size (RSS, /proc/self/statm) and the
+/// heap in use (glibc mallinfo) are read at the start of the event and at
+/// the start and end of every StageTimer stage, so growth is attributed to
+/// the stages of execute() that allocated it; on the other events the stages
+/// only test a flag. Outputs, next to the timing histograms:
+///   "memory_rss", "memory_heap": MB against event number (TProfile, the
+///     memory timeline of the job)
+///   "memory_stage_rss", "memory_stage_heap": kB of growth per stage, summed
+///     over the sampled calls ("memory_stage_calls"), so they add up when the
+///     outputs are merged
+/// A growth of the RSS between two samples above the warning threshold is
+/// reported by BeginEvent(). The first interval is not checked, as the tools
+/// fill their caches there.
+class MemoryMonitor
+{
+
+public:
+	/// RSS and heap in use, in kB
+	struct Usage {
+		double rss;
+		double heap;
+	};
+	static Usage Current();
+
+	/// Books the outputs and attaches to timer, which times (and now measures) the stages;
+	/// wk and timer may not be 0. interval must be > 0
+	MemoryMonitor(EL::Worker* wk, StageTimer* timer, unsigned int interval, double warningKBPerEvent);
+	~MemoryMonitor();
+
+	/// call at the start of every event, before the stages; true if the RSS grew
+	/// faster than the threshold since the previous sample (see GrowthReport())
+	bool BeginEvent();
+	bool Sampling() const { return m_sampling; }
+
+	/// growth of stage on a sampled event
+	void AddStage(StageTimer::Stage stage, const Usage& start, const Usage& end);
+
+	/// growth between the last two samples, e.g. for the warning
+	std::string GrowthReport() const;
+
+	/// set the entries of the output histograms (call once, in finalize())
+	void Finalize();
+
+	/// memory at the first and last sample and one line per stage with its growth, e.g. for finalize()
+	std::string Summary() const;
+
+private:
+	StageTimer* m_timer; //!
+	unsigned int m_interval; //!
+	double m_warningKBPerEvent; //!
+
+	unsigned long m_nEvents; //!
+	unsigned long m_nSamples; //!
+	bool m_sampling; //!
+	Usage m_first; //!
+	Usage m_previous; //!
+	Usage m_last; //!
+	unsigned long m_previousEvent; //!
+	unsigned long m_lastEvent; //!
+
+	double m_stageRss[StageTimer::kNStages]; //!
+	double m_stageHeap[StageTimer::kNStages]; //!
+	unsigned long m_stageCalls[StageTimer::kNStages]; //!
+
+	TProfile* m_rssHist; //!
+	TProfile* m_heapHist; //!
+	TH1D* m_stageRssHist; //!
+	TH1D* m_stageHeapHist; //!
+	TH1D* m_stageCallsHist; //!
+
+};
+
+#endif
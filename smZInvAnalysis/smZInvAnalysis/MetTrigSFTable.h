@@ -0,0 +1,56 @@
+#ifndef MetTrigSFTable_H
+#define MetTrigSFTable_H
+
+#include <string>
+#include <vector>
+
+/// MET trigger scale factors in bins of MET, read from share/metTriggerSF.txt.
+///
+/// The file defines the trigger periods as run-number ranges and, per
+/// (period, channel, jet cut), the MET bin edges and one SF per bin. All
+/// tables are built by Load() in initialize(); Period() is called once per
+/// event with the (random) run number and Get() only does a binary search
+/// over the bin edges, without any allocation.
+class MetTrigSFTable
+{
+
+public:
+	enum Channel { kZnunu = 0, kZmumu, kZee, kWmunu, kWenu, kNChannels };
+	enum JetCut { kExclusive = 0, kInclusive, kNJetCuts };
+
+	MetTrigSFTable();
+
+	/// read the text table; returns false (and prints the reason) if missing or malformed
+	bool Load(const std::string& path);
+
+	/// index of the trigger period containing runNumber, or -1 if none
+	int Period(unsigned int runNumber) const;
+
+	/// scale factor at met [MeV]; 1 outside the bins or without a table
+	float Get(int period, Channel channel, JetCut jetCut, float met) const {
+		if (period < 0) return 1.;
+		return Evaluate(m_tables[(period * kNChannels + channel) * kNJetCuts + jetCut], met);
+	}
+
+	/// number of periods and tables, e.g. for initialize()
+	std::string Summary() const;
+
+private:
+	struct RunRange {
+		std::string name;
+		unsigned int firstRun;
+		unsigned int lastRun;
+	};
+	struct Table {
+		std::vector<float> edges; ///< MeV
+		std::vector<float> sf;
+	};
+
+	static float Evaluate(const Table& table, float met);
+
+	std::vector<RunRange> m_periods; ///< sorted by firstRun
+	std::vector<Table> m_tables; ///< [period][channel][jetCut]
+
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef MultiWeightHist_H
+#define MultiWeightHist_H
+
+#include <TH1.h>
+
+#include <vector>
+
+/// One variable filled with a whole vector of event weights (scale
+/// variations, PDF replicas, ...) at once.
+///
+/// The histograms of the variations are booked as usual, one TH1 each with
+/// the same binning; this class keeps their sums in a contiguous
+/// [(nbins + 2) x nWeights] block, so a fill looks the bin up once and adds
+/// all weights in one (SSE2) loop over a single row. Flush() adds the block
+/// to the booked TH1s, which are what gets written, and zeroes it: it must be
+/// called before the outputs are saved. The TH1s get the same contents,
+/// sum of weights^2, entries and statistics as from one Fill() per weight.
+/// If the histograms do not have the same binning every weight is filled
+/// into its own TH1 directly.
+class MultiWeightHist
+{
+
+public:
+	/// hists are not owned; all must be non-zero
+	MultiWeightHist(const std::vector<TH1*>& hists);
+	~MultiWeightHist();
+
+	unsigned int NWeights() const { return m_hists.size(); }
+	TH1* Get(unsigned int i) const { return m_hists[i]; }
+	/// false if the histograms have different binnings (then every fill goes to the TH1s)
+	bool Merged() const { return m_merged; }
+	/// memory of the accumulated block
+	double Bytes() const { return (m_sumW.size() + m_sumW2.size() + m_stats.size()) * sizeof(double); }
+
+	/// fill x with w[0 .. NWeights()-1], w[i] for histogram i
+	void Fill(double x, const double* w);
+
+	/// add the accumulated block to the histograms and zero it
+	void Flush();
+
+private:
+	std::vector<TH1*> m_hists; //!
+	const TAxis* m_axis; //!
+	bool m_merged; //!
+	unsigned int m_nWeights; //!
+	int m_nBins; //!
+
+	/// per bin (including under/overflow), per weight: sum of w and of w^2
+	std::vector<double> m_sumW; //!
+	std::vector<double> m_sumW2; //!
+	/// per weight, in-range fills only: sum of w, w^2, w*x, w*x^2 (as TH1::GetStats)
+	std::vector<double> m_stats; //!
+	unsigned long m_nFills; //!
+
+};
+
+#endif
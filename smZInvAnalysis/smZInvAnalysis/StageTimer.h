@@ -0,0 +1,121 @@
+#ifndef StageTimer_H
+#define StageTimer_H
+
+#include <TH1D.h>
+
+#include "EventLoop/Worker.h"
+
+#include <chrono>
+#include <string>
+
+class MemoryMonitor;
+
+/// Wall-clock time spent in the main stages of execute(), per worker.
+///
+/// Times are accumulated in plain counters while the job runs and copied into
+/// two histograms in Finalize(): "timing_hist" (total seconds per stage) and
+/// "timing_calls" (number of times each stage ran). Both are added to the
+/// worker output next to cutflow_hist, so they simply add up when the outputs
+/// of several grid/batch jobs are merged; seconds/calls is the mean per call.
+///
+/// Stages nest (e.g. kMuons and the do*Reco functions run inside kExecute),
+/// so every bin is the inclusive time of its stage.
+///
+/// With a MemoryMonitor attached, the stages also measure the memory growth
+/// on the events the monitor samples.
+class StageTimer
+{
+
+public:
+	enum Stage {
+		kExecute = 0,
+		kEventSelection, ///< EventInfo, PRW, GRL, cleaning and trigger decision
+		kTruthAnalysis, ///< truth block of execute()
+		kTruthDressing, ///< truth muon/electron dressing and selection
+		kMuons, ///< calibration and selection, per systematic
+		kElectrons,
+		kPhotons,
+		kTaus,
+		kJets,
+		kOverlapRemoval,
+		kMetRebuild,
+		kZnunuExoticReco,
+		kZmumuExoticReco,
+		kZeeExoticReco,
+		kZnunuSMReco,
+		kZmumuSMReco,
+		kZeeSMReco,
+		kWmunuSMReco,
+		kWenuSMReco,
+		kZmumuTruth,
+		kZllEmulTruth,
+		kZnunuEmulTruth,
+		kNStages
+	};
+
+	/// Books the output histograms; wk may not be 0
+	StageTimer(EL::Worker* wk);
+
+	void Add(Stage stage, std::chrono::steady_clock::duration elapsed) {
+		m_ticks[stage] += elapsed.count();
+		m_calls[stage]++;
+	}
+
+	/// copy the counters into the output histograms (call once, in finalize())
+	void Finalize();
+
+	/// one line per stage with total and mean time, e.g. for finalize()
+	std::string Summary() const;
+
+	/// monitor that gets the memory growth of the stages (not owned; set by MemoryMonitor)
+	void SetMemoryMonitor(MemoryMonitor* monitor) { m_memory = monitor; }
+	/// measure the memory of the stages of this event
+	void SetSamplingMemory(bool sampling) { m_samplingMemory = sampling; }
+
+	/// Times the enclosing scope, or until Stop(). Does nothing if timer is 0,
+	/// so a disabled timer costs one pointer test per stage.
+	class Scope {
+	public:
+		Scope(StageTimer* timer, Stage stage) : m_timer(timer), m_stage(stage), m_memory(false) {
+			if (!m_timer) return;
+			if (m_timer->m_samplingMemory) {
+				m_memory = true;
+				m_timer->StartMemory(m_memoryStart);
+			}
+			m_start = std::chrono::steady_clock::now();
+		}
+		~Scope() { Stop(); }
+		void Stop() {
+			if (!m_timer) return;
+			m_timer->Add(m_stage, std::chrono::steady_clock::now() - m_start);
+			if (m_memory) m_timer->StopMemory(m_stage, m_memoryStart);
+			m_timer = 0;
+		}
+	private:
+		StageTimer* m_timer;
+		Stage m_stage;
+		std::chrono::steady_clock::time_point m_start;
+		bool m_memory;
+		double m_memoryStart[2];
+	};
+
+	static const char* StageName(Stage stage);
+
+private:
+	double Seconds(int stage) const;
+	/// RSS and heap in kB into usage[0], usage[1]; growth since start to the monitor
+	void StartMemory(double* usage) const;
+	void StopMemory(Stage stage, const double* start) const;
+
+	std::chrono::steady_clock::rep m_ticks[kNStages]; //!
+	unsigned long m_calls[kNStages]; //!
+
+	TH1D* m_timingHist; //!
+	TH1D* m_callsHist; //!
+
+	MemoryMonitor* m_memory; //!
+	bool m_samplingMemory; //!
+
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef SystematicsPlan_H
+#define SystematicsPlan_H
+
+#include "PATInterfaces/SystematicSet.h"
+
+#include <string>
+#include <vector>
+
+/// Execution order and object dependence of the systematic variations.
+///
+/// Every CP tool that changes object kinematics is registered together with
+/// the collections it modifies. Each variation is then classified by the
+/// collections it touches; variations touching none of them (scale factors,
+/// JVT/fJVT and b-tagging efficiencies, pile-up weight) are weight-only.
+///
+/// The variations are ordered nominal first, then weight-only, then the
+/// kinematic ones, so that the nominal collections, overlap removal and MET
+/// can be reused unchanged by every weight-only variation.
+class SystematicsPlan
+{
+
+public:
+	/// collections a variation can modify
+	enum Objects {
+		kWeightOnly = 0,
+		kMuons      = 1 << 0,
+		kElectrons  = 1 << 1,
+		kPhotons    = 1 << 2,
+		kTaus       = 1 << 3,
+		kJets       = 1 << 4,
+		kMETSoft    = 1 << 5,
+		kAllObjects = (1 << 6) - 1
+	};
+
+	SystematicsPlan();
+	~SystematicsPlan();
+
+	/// declare that the variations in affecting (a tool's affectingSystematics()) modify objects
+	void RegisterTool(const CP::SystematicSet& affecting, unsigned int objects);
+
+	/// classify and order the variations; the nominal set is always rebuilt from scratch
+	void Build(const std::vector<CP::SystematicSet>& sysList);
+
+	unsigned int Size() const { return m_sys.size(); }
+	const CP::SystematicSet& Sys(unsigned int i) const { return m_sys[i]; }
+	unsigned int Affects(unsigned int i) const { return m_affects[i]; }
+	bool IsNominal(unsigned int i) const { return m_sys[i].name().empty(); }
+	bool IsWeightOnly(unsigned int i) const { return !IsNominal(i) && m_affects[i] == kWeightOnly; }
+
+	/// one-line summary of the classification, e.g. for initialize()
+	std::string Summary() const;
+
+private:
+	unsigned int Classify(const CP::SystematicSet& sys) const;
+
+	std::vector<CP::SystematicSet> m_toolSys; //!
+	std::vector<unsigned int> m_toolObjects; //!
+
+	std::vector<CP::SystematicSet> m_sys; //!
+	std::vector<unsigned int> m_affects; //!
+
+};
+
+#endif
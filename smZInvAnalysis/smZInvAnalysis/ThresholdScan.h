@@ -0,0 +1,37 @@
+#ifndef ThresholdScan_H
+#define ThresholdScan_H
+
+#include <algorithm>
+#include <vector>
+
+/// A lower cut on one variable evaluated at a list of thresholds, e.g. the
+/// leading-jet pT of the met_LeadjetPt<X> and leadpt_vs_met histograms.
+///
+/// For a selection of the form "other cuts && value >= threshold" the
+/// thresholds an event passes are always the lowest NPassed(value) ones.
+/// So the selection is evaluated once, at Lowest(), and if it passes the
+/// scan histograms are filled for the first NPassed(value) thresholds
+/// (HistRegistry::FillScan1D/FillScan2D). The selection does not have to be
+/// run again for every threshold.
+class ThresholdScan
+{
+
+public:
+	/// n > 0 thresholds in increasing order
+	ThresholdScan(const float* thresholds, unsigned int n);
+
+	unsigned int Size() const { return m_thresholds.size(); }
+	float Lowest() const { return m_thresholds.front(); }
+	float Threshold(unsigned int i) const { return m_thresholds[i]; }
+
+	/// number of thresholds t with !(value < t), the comparison of the jet selections
+	unsigned int NPassed(float value) const {
+		return std::upper_bound(m_thresholds.begin(), m_thresholds.end(), value) - m_thresholds.begin();
+	}
+
+private:
+	std::vector<float> m_thresholds;
+
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef WeightVariationIndex_H
+#define WeightVariationIndex_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+
+/// Read-only lookup of MC generator weight positions keyed by (DSID, weight name).
+///
+/// The table is kept in share/mcWeightVariations.txt and converted once
+/// (makeWeightVariationIndex) into a binary file holding a sorted entry array
+/// followed by a string pool. The binary file is memory-mapped, so opening it
+/// costs no allocation and every lookup is a binary search over the mapping.
+///
+/// Binary layout (little endian):
+///   char     magic[8]        "SMZWIDX1"
+///   uint32_t nEntries
+///   uint32_t poolSize
+///   Entry    entries[nEntries]   sorted by (dsid, name)
+///   char     pool[poolSize]      weight names, not null-terminated
+class WeightVariationIndex
+{
+
+public:
+	struct Entry {
+		uint32_t dsid;
+		uint32_t nameOffset;
+		uint32_t nameLength;
+		int32_t  index;
+	};
+
+	WeightVariationIndex();
+	~WeightVariationIndex();
+
+	/// map the binary index file; returns false if missing or malformed
+	bool Open(const std::string& path);
+	void Close();
+	bool IsOpen() const { return m_base != 0; }
+
+	/// position of weightName for dsid, or defaultIndex if not listed
+	int Find(uint32_t dsid, const char* weightName, int defaultIndex = 0) const;
+	bool HasDsid(uint32_t dsid) const;
+	unsigned int Size() const { return m_nEntries; }
+
+	/// convert the text table (<DSID> <index> <weight name>) into the binary index
+	static bool Build(const std::string& txtPath, const std::string& idxPath);
+
+private:
+	int Compare(const Entry& e, uint32_t dsid, const char* name, std::size_t length) const;
+
+	void* m_base; //!
+	std::size_t m_mapSize; //!
+	const Entry* m_entries; //!
+	const char* m_pool; //!
+	uint32_t m_nEntries; //!
+	uint32_t m_poolSize; //!
+
+};
+
+#endif
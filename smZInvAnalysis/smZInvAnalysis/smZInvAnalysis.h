@@ -36,6 +36,7 @@
 #include "PileupReweighting/PileupReweightingTool.h"
 
 // EDM
+#include "xAODEventInfo/EventInfo.h"
 #include "xAODTracking/VertexContainer.h"
 #include "xAODTracking/TrackParticleContainer.h"
 #include "xAODTracking/TrackParticlexAODHelpers.h"
@@ -129,6 +130,51 @@
 // Cutflow
 #include <smZInvAnalysis/BitsetCutflow.h>
 
+// MC weight-variation index
+#include <smZInvAnalysis/WeightVariationIndex.h>
+
+// Histogram handles
+#include <smZInvAnalysis/HistRegistry.h>
+
+// Leading-jet pT threshold scans
+#include <smZInvAnalysis/ThresholdScan.h>
+
+// Systematic variation classification
+#include <smZInvAnalysis/SystematicsPlan.h>
+
+// Per-event deep-copy containers
+#include <smZInvAnalysis/DeepCopyPool.h>
+
+// Flat ntuple output
+#include <smZInvAnalysis/FlatNtuple.h>
+
+// On-demand input containers
+#include <smZInvAnalysis/LazyEventData.h>
+
+// Per-stage timing
+#include <smZInvAnalysis/StageTimer.h>
+
+// Memory use per stage and timeline
+#include <smZInvAnalysis/MemoryMonitor.h>
+
+// Rebuilt MET variants
+#include <smZInvAnalysis/METVariantCache.h>
+
+// MET trigger scale factors
+#include <smZInvAnalysis/MetTrigSFTable.h>
+
+// Lepton scale factors per event and systematic
+#include <smZInvAnalysis/LeptonSFCache.h>
+
+// Structure-of-arrays copy of the selected objects
+#include <smZInvAnalysis/EventSnapshot.h>
+
+// Vectorised deltaPhi/deltaR over object arrays
+#include <smZInvAnalysis/KinematicKernels.h>
+
+// 4-vector of the analysis-side kinematics
+#include <smZInvAnalysis/FourMomentum.h>
+
 // PMGTruthWeightTool
 #include "PMGTools/PMGTruthWeightTool.h"
 
@@ -139,6 +185,27 @@ class smZInvAnalysis : public EL::Algorithm
 public:
   // float cutValue;
 
+  // name of the output stream for the flat ntuple (no ntuple if empty)
+  std::string outputName;
+
+  // write the per-stage timing histograms (see StageTimer); off by default
+  bool doTiming;
+
+  // truth-level analysis only, for any MC input (TRUTH1 always runs this way): no reco tools, containers or systematics
+  bool truthOnly;
+
+  // create each histogram on its first fill (never-filled histograms are not written); off by default
+  bool lazyHistBooking;
+
+  // book the 2D unfolding matrices as THnSparseF, which stores only the filled bins; off by default
+  bool sparseMatrices;
+
+  // sample RSS and heap every this many events and write the memory histograms (see MemoryMonitor), with the
+  // timing histograms of the stages it measures; 0 (default) is off
+  unsigned int memoryMonitorInterval;
+  // warn when the RSS grows by more than this many kB per event between two samples
+  double memoryGrowthWarning;
+
   xAOD::TEvent *m_event; //!
   xAOD::TStore *m_store; //!
 
@@ -149,10 +216,16 @@ public:
   bool m_isData; //!
   bool is_customDerivation; //!
   std::string m_dataType; //!
+  // m_dataType is an EXOT (EXOT5) or STDM (STDM4) derivation
+  bool m_isEXOT; //!
+  bool m_isSTDM; //!
   std::string m_nameDerivation; //!
   std::string m_nameDataset; //!
-  std::string m_dataYear; //!
-  std::string m_run2016Period; //!
+  // data-taking year and 2016 trigger period of the (random) run number, see setDataPeriod()
+  enum DataYear { kNoYear = 0, k2015, k2016, k2017 };
+  enum Run2016Period { kNo2016Period = 0, k2016AtoD3, k2016D4toL };
+  DataYear m_dataYear; //!
+  Run2016Period m_run2016Period; //!
   std::string m_ZtruthChannel; //!
   std::string m_generatorType; //!
   std::string m_input_filename; //!
@@ -173,9 +246,6 @@ public:
   bool m_isWenu; //!
   bool m_isZemu; //!
 
-  std::string h_channel; //!
-  std::string h_level; //!
-
   // Enable Reconstruction level analysis
   bool m_doReco; //!
 
@@ -210,12 +280,66 @@ public:
   // Custom classes (BitsetCutflow)
   BitsetCutflow* m_BitsetCutflow; //!
   bool m_useBitsetCutflow; //!
+  // BitsetCutflow step IDs, registered in initialize()
+  // event selection steps of cutflow_hist
+  enum EventCutflowStep { kCutflowTotal = 0, kCutflowGRL, kCutflowLArTileCore, kCutflowBatman, kCutflowPrimaryVertex, kNEventCutflowSteps };
+  unsigned int m_eventCutflowStep[kNEventCutflowSteps]; //!
+  // nominal cutflow tests of execute() (m_useArrayCutflow), one cutflow per channel (FlatNtuple::kZnunu, kZmumu, kZee)
+  enum LocalCutflowStep {
+    kCutMETTrigger = 0, kCutElectronTrigger, kCutTwoMuons, kCutDimuon, kCutTwoElectrons, kCutDielectron, kCutMET, kCutJetCleaning,
+    kCutLeadingJet, kCutTwoJets, kCutVBFJetPt, kCutMjj, kCutJetMETVeto, kCutMuonVeto, kCutIsoMuonVeto, kCutElectronVeto,
+    kCutExactTwoElectrons, kCutTauVeto, kCutCJV, kNLocalCutflowSteps
+  };
+  unsigned int m_localCutflow[3]; //!
+  unsigned int m_localCutflowStep[3][kNLocalCutflowSteps]; //!
+  // SM reco selections (hist prefix "_reco_exclusive_", "_reco_inclusive_")
+  enum RecoSelection { kRecoExclusive = 0, kRecoInclusive, kNRecoSelections };
+  // SM reco cutflows: m_recoCutflow[(systematic * 5 + channel) * kNRecoSelections + selection]
+  enum RecoCutflowStep { kRecoCutflowPreselection = 0, kRecoCutflowMET, kNRecoCutflowSteps };
+  std::vector<unsigned int> m_recoCutflow; //!
+  unsigned int m_recoCutflowStep[kNRecoCutflowSteps]; //!
+
+  // Histogram blocks (HistRegistry::Block()) of every fill context, resolved in initialize() by
+  // resolveHistBlocks(): execute() indexes them by channel, selection and m_sysIndex instead of
+  // building prefixes and looking the blocks up by name
+  // monojet/VBF plots of the exotic reco channels: prefix "h_znunu_", "h_zmumu_", "h_zee_", then the
+  // Zmumu Cz plots "h_zmumu_<RecoJets|GoodJets|TruthJets>TruthMET<TruthCuts|RecoCuts>_"
+  enum ExoticPlot {
+    kExoticZnunu = 0, kExoticZmumu, kExoticZee,
+    kExoticRecoJetsTruthCuts, kExoticGoodJetsTruthCuts, kExoticTruthJetsTruthCuts,
+    kExoticRecoJetsRecoCuts, kExoticGoodJetsRecoCuts, kExoticTruthJetsRecoCuts, kNExoticPlots
+  };
+  // truth levels of doZmumuTruth() (prefix "nominal_truth_", "born_truth_", "bare_truth_", "dress_truth_")
+  enum ZmumuTruthLevel { kZmumuTruthNominal = 0, kZmumuTruthBorn, kZmumuTruthBare, kZmumuTruthDress, kNZmumuTruthLevels };
+  // jets and selections of the emulated truth analyses: prefix "_<jets>_<selection>_", "fid_" appended for the fiducial cuts
+  enum EmulJets {
+    kEmulDressWZ = 0, kEmulDressOR, kEmulDressOS, kEmulDressCustom,
+    kEmulBareCustom, kEmulBareEmul, kEmulBareOR, kEmulBareOS,
+    kEmulBornCustom, kEmulBornEmul, kNEmulJets
+  };
+  enum EmulSelection { kEmulExclusive = 0, kEmulInclusive, kEmulNoJetSelection, kNEmulSelections };
+  const int* m_eventBlock; //!
+  const int* m_truthLevelBlocks[2][2]; //! [0 zmumu, 1 zee][0 nominal, 1 dress]
+  const int* m_zmumuTruthBlocks[kNZmumuTruthLevels]; //!
+  const int* m_zmumuTruthMonojetBlocks[kNZmumuTruthLevels]; //!
+  const int* m_zmumuTruthVBFBlocks[kNZmumuTruthLevels]; //!
+  const int* m_zllEmulBlocks[2][kNEmulJets][kNEmulSelections][2]; //! [0 zmumu, 1 zee][jets][selection][fiducial]
+  const int* m_znunuEmulBlocks[kNEmulSelections]; //!
+  // per systematic of m_sysPlan (0 for the skipped ones)
+  std::vector<const int*> m_execSysBlocks; //!
+  std::vector<const int*> m_zmumuExoticBlocks; //!
+  std::vector<const int*> m_exoticMonojetBlocks; //! [systematic * kNExoticPlots + plot]
+  std::vector<const int*> m_exoticVBFBlocks; //! same indexing
+  std::vector<const int*> m_recoSMBlocks; //! same indexing as m_recoCutflow
 
   // Cut values for SM study
   bool sm_doORMuon; //!
   float sm_metCut; //!
   bool sm_doPhoton_MET; //!
   bool sm_doTau_MET; //!
+  // Objects that only some channels/options read (resolved in initialize)
+  bool m_needPhotons; //!
+  bool m_needTaus; //!
   float sm_ORJETdeltaR; //!
   // Jet pT
   float sm_goodJetPtCut; //!
@@ -309,8 +433,7 @@ public:
 
 
   // Histogram
-  std::map<std::string, TH1*> hMap1D; //!
-  std::map<std::string, TH2*> hMap2D; //!
+  HistRegistry* m_hist; //!
 
   // trigger tools member variables
   Trig::TrigDecisionTool *m_trigDecisionTool; //!
@@ -382,9 +505,23 @@ public:
 
   // list of systematics
   std::vector<CP::SystematicSet> m_sysList; //!
+  // systematics ordered and classified by the collections they modify
+  SystematicsPlan* m_sysPlan; //!
+  // index in m_sysPlan of the systematic being processed in execute()
+  unsigned int m_sysIndex; //!
+  // name of each systematic of m_sysPlan and whether skipSystematic() drops it, taken in initialize()
+  std::vector<std::string> m_sysNames; //!
+  std::vector<bool> m_sysSkip; //!
 
   // Retrieve MC Weight for a different choice of scale, PDF
-  std::map<int, std::map<std::string, int> > m_variations; //!
+  WeightVariationIndex* m_weightIndex; //!
+  uint32_t m_weightIndexDsid; //! DSID whose indices were last reported
+  int m_index_MUR1_MUF2; //!
+  int m_index_MUR1_MUF05; //!
+  int m_index_MUR2_MUF1; //!
+  int m_index_MUR05_MUF1; //!
+  int m_index_MUR05_MUF05; //!
+  int m_index_MUR2_MUF2; //!
   std::map<std::string, float> m_mcScaledMCWeight; //!
   std::map<std::string, float> m_scaledSumOfWeight; //!
 
@@ -400,45 +537,75 @@ public:
   //----------------------------------------------------------------------------------
   // Global deep copied new objects/containers to use my function, i.e. plotMonojet()
   //----------------------------------------------------------------------------------
+  // owner of the deep copied containers below (except MET)
+  DeepCopyPool* m_pool; //!
+
+  // flat ntuple of the selected SM reco events (0 if outputName is empty)
+  FlatNtuple* m_ntuple; //!
+
+  // input containers, read from the TEvent on first access in the event
+  LazyEventData* m_lazy; //!
+
+  // per-stage timing (0 unless doTiming is set)
+  StageTimer* m_timer; //!
+
+  // memory sampling (0 unless memoryMonitorInterval is set)
+  MemoryMonitor* m_memory; //!
+
+  // MET variants rebuilt for the current event and systematic, shared by the do*Reco functions
+  METVariantCache* m_metCache; //!
+
+  // MET trigger SF tables (share/metTriggerSF.txt) and the trigger period of the current event
+  MetTrigSFTable* m_metTrigSFTable; //!
+  int m_metTrigPeriod; //!
+
+  // lepton SFs of the selected leptons, per systematic slot
+  LeptonSFCache* m_sfCache; //!
+  // weight-only systematics changing a lepton SF, one per slot 1..: their m_sysPlan index and the SF components
+  // they change (bit LeptonSFCache::MuonSF, or kNComponents + LeptonSFCache::ElectronSF); m_sfSlot[iSys] is 0 for the others
+  std::vector<unsigned int> m_sfWeightSys; //!
+  std::vector<unsigned int> m_sfWeightSysAffects; //!
+  std::vector<unsigned int> m_sfSlot; //!
+
+  // kinematics of the selected objects and the real MET of the current systematic, read by the reco selections and plots
+  EventSnapshot* m_snapshot; //!
+
+  // eta/phi of the truth jets and dressed leptons of the truth jet overlap removal, and the min deltaR per jet
+  std::vector<float> m_orJetEta; //!
+  std::vector<float> m_orJetPhi; //!
+  std::vector<float> m_orLeptonEta; //!
+  std::vector<float> m_orLeptonPhi; //!
+  std::vector<float> m_truthJetDRMin; //!
+  // eta/phi of the jets and of the two leading electrons of an overlap subtraction, the jet-electron
+  // deltaR matrix (m_osDR[i*nElectrons + j]) and the min deltaR of each electron over the jets
+  std::vector<float> m_osJetEta; //!
+  std::vector<float> m_osJetPhi; //!
+  std::vector<float> m_osLeptonEta; //!
+  std::vector<float> m_osLeptonPhi; //!
+  std::vector<float> m_osDR; //!
+  float m_osDRMin[2]; //!
+
   // Particle (truth) level
   xAOD::TruthParticleContainer* m_selectedTruthNeutrino; //!
-  xAOD::AuxContainerBase* m_selectedTruthNeutrinoAux; //!
   xAOD::TruthParticleContainer* m_dressedTruthMuon; //!
-  xAOD::AuxContainerBase* m_dressedTruthMuonAux; //!
   xAOD::TruthParticleContainer* m_dressedTruthElectron; //!
-  xAOD::AuxContainerBase* m_dressedTruthElectronAux; //!
   xAOD::TruthParticleContainer* m_selectedTruthTau; //!
-  xAOD::AuxContainerBase* m_selectedTruthTauAux; //!
   xAOD::JetContainer* m_selectedTruthJet; //!
-  xAOD::AuxContainerBase* m_selectedTruthJetAux; //!
   xAOD::JetContainer* m_selectedTruthWZJet; //!
-  xAOD::AuxContainerBase* m_selectedTruthWZJetAux; //!
 
   // Reco level
   xAOD::JetContainer* m_allJet; //!
-  xAOD::AuxContainerBase* m_allJetAux; //!
   xAOD::JetContainer* m_goodJet; //!
-  xAOD::AuxContainerBase* m_goodJetAux; //!
   xAOD::JetContainer* m_goodJetORTruthNuNu; //!
-  xAOD::AuxContainerBase* m_goodJetORTruthNuNuAux; //!
   xAOD::JetContainer* m_goodJetORTruthMuMu; //!
-  xAOD::AuxContainerBase* m_goodJetORTruthMuMuAux; //!
   xAOD::JetContainer* m_goodJetORTruthElEl; //!
-  xAOD::AuxContainerBase* m_goodJetORTruthElElAux; //!
   xAOD::JetContainer* m_goodOSJet; //!
-  xAOD::AuxContainerBase* m_goodOSJetAux; //!
   xAOD::MuonContainer* m_goodMuon; //!
-  xAOD::AuxContainerBase* m_goodMuonAux; //!
   xAOD::MuonContainer* m_goodMuonForZ; //!
-  xAOD::AuxContainerBase* m_goodMuonForZAux; //!
   xAOD::ElectronContainer* m_baselineElectron; //!
-  xAOD::AuxContainerBase* m_baselineElectronAux; //!
   xAOD::ElectronContainer* m_goodElectron; //!
-  xAOD::AuxContainerBase* m_goodElectronAux; //!
   xAOD::PhotonContainer* m_goodPhoton; //!
-  xAOD::AuxContainerBase* m_goodPhotonAux; //!
   xAOD::TauJetContainer* m_goodTau; //!
-  xAOD::AuxContainerBase* m_goodTauAux; //!
   xAOD::MissingETContainer* m_met; //!
   xAOD::MissingETAuxContainer* m_metAux; //!
 
@@ -466,50 +633,104 @@ public:
   virtual EL::StatusCode histFinalize ();
 
   // Custom made functions
-  virtual EL::StatusCode addHist(std::map<std::string, TH1*> &hMap, std::string tag,
+  // Book a histogram and return its HistRegistry handle
+  virtual int addHist(std::string tag,
       int bins, double min, double max);
 
-  virtual EL::StatusCode addHist(std::map<std::string, TH1*> &hMap, std::string tag,
+  virtual int addHist(std::string tag,
       int bins, Float_t binArray[]);
 
-  virtual EL::StatusCode addHist(std::map<std::string, TH2*> &hMap, std::string tag, 
+  virtual int addHist(std::string tag,
       int binsX, double minX, double maxX,
       int binsY, double minY, double maxY);
 
-  virtual EL::StatusCode addHist(std::map<std::string, TH2*> &hMap, std::string tag, 
+  virtual int addHist(std::string tag,
       int binsX, Float_t binArrayX[],
-      int binsY, Float_t binArrayY[]);
+      int binsY, Float_t binArrayY[], bool sparse = false);
 
 
   float deltaPhi(float phi1, float phi2);
 
   float deltaR(float eta1, float eta2, float phi1, float phi2);
-
+  // m_truthJetDRMin[i]: min deltaR of truth jet i to the dressed truth leptons of the overlap removal
+  void truthJetLeptonDRMin(const xAOD::JetContainer& truthJets);
+  // m_osDR and m_osDRMin of jets against the (up to) two leading leptons
+  template <class CONT> void jetLeptonDR(const xAOD::JetContainer& jets, const CONT& leptons);
+  // deltaR of jet i to lepton j of the last jetLeptonDR()
+  float osDR(unsigned int i, unsigned int j) const { return m_osDR[i*m_osLeptonEta.size() + j]; }
+
+  // GRL, detector quality and Batman cleaning (reject data only), then the trigger decision (no rejection)
+  bool passEventPrefilter(const xAOD::EventInfo& eventInfo);
+  // systematics of the reco loop that are not run for this job (data, doSys off, or not affecting the channels run)
+  bool skipSystematic(const std::string& sysName) const;
+  // BitsetCutflow cutflows of the nominal cutflow tests and of the SM reco selections (of the current systematic)
+  void passLocalCutflow(int channel, LocalCutflowStep step);
+  unsigned int recoCutflow(int channel, RecoSelection selection) const;
+  // fill the histogram block tables; called at the end of initialize(), once all histograms are booked
+  void resolveHistBlocks();
+  // m_dataYear and m_run2016Period of a (random) run number
+  void setDataPeriod(unsigned int runNumber);
+  // METVariantCache definition of the real MET built in execute() and doZnunuSMReco()
+  unsigned int realMETDefinition() const;
+  // copy the good jets, OS jets and leptons of the current systematic into m_snapshot
+  void fillEventSnapshot(float met, float metPhi);
+
+  // Preselection of the reco channels (object counts, lepton pT and charge, vetoes, trigger),
+  // checked before their MET rebuild
+  bool passZnunuExoticPreselection();
+  bool passZeeExoticPreselection();
+  bool passZnunuSMPreselection();
+  bool passZmumuSMPreselection();
+  bool passZeeSMPreselection();
+  bool passWmunuSMPreselection(const float& met, const float& metPhi);
+  bool passWenuSMPreselection(const xAOD::ElectronContainer* goodElectron, const float& met, const float& metPhi);
+
+  // Monojet and VBF phase space: the xAOD versions for truth (and truth-OR) jets, the EventSnapshot ones for the good reco jets
   bool passMonojet(const xAOD::JetContainer* goodJet, const float& metPhi);
   bool passDijet(const xAOD::JetContainer* goodJet, const float& metPhi);
   bool passVBF(const xAOD::JetContainer* goodJet, const float& metPhi);
-
-  void plotMonojet(const xAOD::JetContainer* goodJet, const float& met, const float& metPhi, const float& mcEventWeight, std::string hist_prefix, std::string sysName);
-  void plotVBF(const xAOD::JetContainer* goodJet, const float& met, const float& metPhi, const float& mcEventWeight, std::string hist_prefix, std::string sysName);
-
-  void doZnunuExoticReco(const xAOD::MissingETContainer* metCore, const xAOD::MissingETAssociationMap* metMap, const float& mcEventWeight, std::string sysName);
-  void doZmumuExoticReco(const xAOD::MissingETContainer* metCore, const xAOD::MissingETAssociationMap* metMap, const xAOD::MuonContainer* muons, const xAOD::MuonContainer* muonSC, const float& mcEventWeight, std::string sysName);
-  void doZeeExoticReco(const xAOD::MissingETContainer* metCore, const xAOD::MissingETAssociationMap* metMap, const xAOD::ElectronContainer* elecSC, const float& mcEventWeight, std::string sysName);
-  void doZnunuSMReco(const xAOD::MissingETContainer* metCore, const xAOD::MissingETAssociationMap* metMap, const float& mcEventWeight, std::string hist_prefix, std::string sysName);
-  void doZmumuSMReco(const xAOD::MissingETContainer* metCore, const xAOD::MissingETAssociationMap* metMap, const xAOD::MuonContainer* muons, const xAOD::MuonContainer* muonSC, const float& mcEventWeight, std::string hist_prefix, std::string sysName);
-  void doZeeSMReco(const xAOD::MissingETContainer* metCore, const xAOD::MissingETAssociationMap* metMap, const float& met, const float& metPhi, const xAOD::ElectronContainer* elecSC, const float& mcEventWeight, std::string hist_prefix, std::string sysName);
-  void doWmunuSMReco(const xAOD::MissingETContainer* metCore, const xAOD::MissingETAssociationMap* metMap, const float& met, const float& metPhi, const float& mcEventWeight, std::string hist_prefix, std::string sysName);
-  void doWenuSMReco(const xAOD::MissingETContainer* metCore, const xAOD::MissingETAssociationMap* metMap, const float& met, const float& metPhi, const xAOD::ElectronContainer* elecSC, xAOD::ElectronContainer* goodElectron, const float& mcEventWeight, std::string hist_prefix, std::string sysName);
-  void doZmumuTruth(const xAOD::TruthParticleContainer* truthMuon, const float& mcEventWeight, std::string hist_prefix, std::string sysName);
-  void doZllEmulTruth(const xAOD::TruthParticleContainer* truthLepton, const xAOD::JetContainer* truthJet, const float& lep1Pt, const float& lep2Pt, const float& lepEta, const float& mcEventWeight, std::string channel, std::string hist_prefix );
-  void doZnunuEmulTruth(const xAOD::TruthParticleContainer* truthLepton, const xAOD::JetContainer* truthJet, const float& mcEventWeight, std::string channel, std::string hist_prefix );
+  bool passMonojet(const EventSnapshot::Objects& recoJet, const float& metPhi);
+  bool passDijet(const EventSnapshot::Objects& recoJet, const float& metPhi);
+  bool passVBF(const EventSnapshot::Objects& recoJet, const float& metPhi);
+
+  // hist: block of the prefix and systematic (m_exoticMonojetBlocks/m_exoticVBFBlocks, m_zmumuTruthMonojetBlocks/m_zmumuTruthVBFBlocks)
+  void plotMonojet(const xAOD::JetContainer* goodJet, const float& met, const float& metPhi, const float& mcEventWeight, const int* hist);
+  void plotVBF(const xAOD::JetContainer* goodJet, const float& met, const float& metPhi, const float& mcEventWeight, const int* hist);
+  void plotMonojet(const EventSnapshot::Objects& recoJet, const float& met, const float& metPhi, const float& mcEventWeight, const int* hist);
+  void plotVBF(const EventSnapshot::Objects& recoJet, const float& met, const float& metPhi, const float& mcEventWeight, const int* hist);
+
+  // Run all reco-level channel analyses for one systematic
+  void doRecoAnalysis(const xAOD::MissingETContainer* metCore, const xAOD::MissingETAssociationMap* metMap, const xAOD::MuonContainer* muons, const xAOD::MuonContainer* muonSC, const xAOD::ElectronContainer* elecSC, const float& met, const float& metPhi, const std::string& sysName);
+  void doZnunuExoticReco(const xAOD::MissingETContainer* metCore, const xAOD::MissingETAssociationMap* metMap, const float& mcEventWeight, const std::string& sysName);
+  void doZmumuExoticReco(const xAOD::MissingETContainer* metCore, const xAOD::MissingETAssociationMap* metMap, const xAOD::MuonContainer* muons, const xAOD::MuonContainer* muonSC, const float& mcEventWeight, const std::string& sysName);
+  void doZeeExoticReco(const xAOD::MissingETContainer* metCore, const xAOD::MissingETAssociationMap* metMap, const xAOD::ElectronContainer* elecSC, const float& mcEventWeight, const std::string& sysName);
+  void doZnunuSMReco(const xAOD::MissingETContainer* metCore, const xAOD::MissingETAssociationMap* metMap, const float& mcEventWeight, RecoSelection selection, const std::string& sysName);
+  void doZmumuSMReco(const xAOD::MissingETContainer* metCore, const xAOD::MissingETAssociationMap* metMap, const xAOD::MuonContainer* muons, const xAOD::MuonContainer* muonSC, const float& mcEventWeight, RecoSelection selection, const std::string& sysName);
+  void doZeeSMReco(const xAOD::MissingETContainer* metCore, const xAOD::MissingETAssociationMap* metMap, const float& met, const float& metPhi, const xAOD::ElectronContainer* elecSC, const float& mcEventWeight, RecoSelection selection, const std::string& sysName);
+  void doWmunuSMReco(const xAOD::MissingETContainer* metCore, const xAOD::MissingETAssociationMap* metMap, const float& met, const float& metPhi, const float& mcEventWeight, RecoSelection selection, const std::string& sysName);
+  void doWenuSMReco(const xAOD::MissingETContainer* metCore, const xAOD::MissingETAssociationMap* metMap, const float& met, const float& metPhi, const xAOD::ElectronContainer* elecSC, xAOD::ElectronContainer* goodElectron, const float& mcEventWeight, RecoSelection selection, const std::string& sysName);
+  void doZmumuTruth(const xAOD::TruthParticleContainer* truthMuon, const float& mcEventWeight, ZmumuTruthLevel level);
+  // channel: FlatNtuple::kZmumu or kZee
+  void doZllEmulTruth(const xAOD::TruthParticleContainer* truthLepton, const xAOD::JetContainer* truthJet, const float& lep1Pt, const float& lep2Pt, const float& lepEta, const float& mcEventWeight, FlatNtuple::Channel channel, EmulJets jets, EmulSelection selection, bool fiducial );
+  void doZnunuEmulTruth(const xAOD::TruthParticleContainer* truthLepton, const xAOD::JetContainer* truthJet, const float& mcEventWeight, EmulSelection selection );
   bool passExclusiveTruthJet(const xAOD::JetContainer* truthJet, const float& leadJetPt, const float& metPhi);
   bool passInclusiveTruthJet(const xAOD::JetContainer* truthJet, const float& leadJetPt, const float& metPhi);
-  bool passExclusiveRecoJet(const xAOD::JetContainer* recoJet, const float& leadJetPt, const float& metPhi);
-  bool passInclusiveRecoJet(const xAOD::JetContainer* recoJet, const float& leadJetPt, const float& metPhi);
-  bool passInclusiveRecoJetNoDPhiJetMET(const xAOD::JetContainer* recoJet, const float& leadJetPt, const float& metPhi);
-  bool passExclusiveMultijetCR(const xAOD::JetContainer* recoJet, const float& leadJetPt, const float& metPhi);
-  bool passInclusiveMultijetCR(const xAOD::JetContainer* recoJet, const float& leadJetPt, const float& metPhi);
+  bool passExclusiveRecoJet(const EventSnapshot::Objects& recoJet, const float& leadJetPt, const float& metPhi);
+  bool passInclusiveRecoJet(const EventSnapshot::Objects& recoJet, const float& leadJetPt, const float& metPhi);
+  bool passInclusiveRecoJetNoDPhiJetMET(const EventSnapshot::Objects& recoJet, const float& leadJetPt, const float& metPhi);
+  bool passExclusiveMultijetCR(const EventSnapshot::Objects& recoJet, const float& leadJetPt, const float& metPhi);
+  bool passInclusiveMultijetCR(const EventSnapshot::Objects& recoJet, const float& leadJetPt, const float& metPhi);
+
+  // Lepton SF stage: every SF tool once per selected lepton, for the current systematic and,
+  // on the nominal, for the weight-only systematics; GetGoodMuonSF/GetGoodElectronSF read the cache
+  void evaluateLeptonSFs(const CP::SystematicSet& sys, bool withWeightSys);
+  // SF tool of a component bit (see m_sfWeightSysAffects); 0 for the muon trigger SF, which has no systematics
+  CP::ISystematicsTool* leptonSFTool(unsigned int bit) const;
+  void applyLeptonSFSystematic(const CP::SystematicSet& sys, unsigned int affects);
+  float muonSF(xAOD::Muon& mu, LeptonSFCache::MuonSF component);
+  float electronSF(xAOD::Electron& elec, LeptonSFCache::ElectronSF component);
+  float cachedMuonSF(xAOD::Muon& mu, LeptonSFCache::MuonSF component);
+  float cachedElectronSF(xAOD::Electron& elec, LeptonSFCache::ElectronSF component);
 
   float GetGoodMuonSF(xAOD::Muon& mu, const bool recoSF, const bool isoSF, const bool ttvaSF, const bool muonTrigSF);
   double GetTotalMuonSF(xAOD::MuonContainer& muons, bool recoSF, bool isoSF, bool ttvaSF, bool muonTrigSF);
@@ -517,11 +738,14 @@ public:
   float GetGoodElectronSF(xAOD::Electron& elec, const bool recoSF, const bool idSF, const bool isoSF, const bool elecTrigSF);
   float GetTotalElectronSF(xAOD::ElectronContainer& electrons, bool recoSF, bool idSF, bool isoSF, bool elecTrigSF);
 
-  float GetMetTrigSF(const float& met, std::string jetCut, std::string channel);
+  float GetMetTrigSF(const float& met, MetTrigSFTable::JetCut jetCut, MetTrigSFTable::Channel channel);
+
+  // Write one flat ntuple row for the current event in the given SM channel
+  void fillFlatNtuple(const FlatNtuple::Channel& channel, const float& met, const float& metPhi, const float& mll, const float& mT, const int& channelCuts, const float& mcEventWeight, const float& lepSF);
 
 
   // this is needed to distribute the algorithm to the workers
-  ClassDef(smZInvAnalysis, 1);
+  ClassDef(smZInvAnalysis, 3);
 };
 
 #endif
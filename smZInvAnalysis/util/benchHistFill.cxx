@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <TH1F.h>
+
+#include "smZInvAnalysis/HistRegistry.h"
+#include "smZInvAnalysis/MultiWeightHist.h"
+
+// Fill-rate benchmark: string-keyed std::map lookups (as in the old hMap1D)
+// against HistRegistry handle blocks, on a SM-reco-like set of histograms,
+// and one Fill() per event weight against a MultiWeightHist.
+
+namespace {
+
+  const char* const kVariables[] = {
+    "met", "MET_mono", "fullmll_met", "only66mll_met", "mll", "jet_n", "jet_pt", "jet_eta", "jet_phi",
+    "lep1_pt", "lep1_eta", "lep1_phi", "lep2_pt", "lep2_eta", "lep2_phi", "dPhiJetMet", "dPhiMinJetMet",
+    "jet1_pt", "jet1_eta", "jet1_phi", "jet2_pt", "jet2_eta", "jet2_phi", "jet3_pt", "jet3_eta", "jet3_phi",
+    "met_noMetTrig", "MET_mono_noMetTrig", "fullmll_met_noMetTrig", "only66mll_met_noMetTrig"
+  };
+  const int kNVariables = sizeof(kVariables)/sizeof(kVariables[0]);
+
+  const char* const kTemplates[] = {
+    "SM_study_{c}{p}met{s}", "SM_study_{c}{p}MET_mono{s}", "SM_study_{c}{p}fullmll_met{s}", "SM_study_{c}{p}only66mll_met{s}",
+    "SM_study_{c}{p}mll{s}", "SM_study_{c}{p}jet_n{s}", "SM_study_{c}{p}jet_pt{s}", "SM_study_{c}{p}jet_eta{s}",
+    "SM_study_{c}{p}jet_phi{s}", "SM_study_{c}{p}lep1_pt{s}", "SM_study_{c}{p}lep1_eta{s}", "SM_study_{c}{p}lep1_phi{s}",
+    "SM_study_{c}{p}lep2_pt{s}", "SM_study_{c}{p}lep2_eta{s}", "SM_study_{c}{p}lep2_phi{s}", "SM_study_{c}{p}dPhiJetMet{s}",
+    "SM_study_{c}{p}dPhiMinJetMet{s}", "SM_study_{c}{p}jet1_pt{s}", "SM_study_{c}{p}jet1_eta{s}", "SM_study_{c}{p}jet1_phi{s}",
+    "SM_study_{c}{p}jet2_pt{s}", "SM_study_{c}{p}jet2_eta{s}", "SM_study_{c}{p}jet2_phi{s}", "SM_study_{c}{p}jet3_pt{s}",
+    "SM_study_{c}{p}jet3_eta{s}", "SM_study_{c}{p}jet3_phi{s}", "SM_study_{c}{p}met_noMetTrig{s}",
+    "SM_study_{c}{p}MET_mono_noMetTrig{s}", "SM_study_{c}{p}fullmll_met_noMetTrig{s}", "SM_study_{c}{p}only66mll_met_noMetTrig{s}"
+  };
+  const HistTemplates kBenchHists = { kTemplates, sizeof(kTemplates)/sizeof(kTemplates[0]), kNVariables };
+
+  const char* const kChannels[] = {"znunu", "zee", "zmumu", "wenu", "wmunu"};
+  const char* const kPrefixes[] = {"_reco_exclusive_", "_reco_inclusive_"};
+
+}
+
+int main( int argc, char* argv[] ) {
+
+  // Number of events, systematics and event weights can be given as arguments
+  int nEvents = 2000;
+  int nSys = 20;
+  int nWeights = 100;
+  if( argc > 1 ) nEvents = std::atoi( argv[ 1 ] );
+  if( argc > 2 ) nSys = std::atoi( argv[ 2 ] );
+  if( argc > 3 ) nWeights = std::atoi( argv[ 3 ] );
+
+  TH1::AddDirectory(kFALSE);
+
+  std::vector<std::string> sysNames;
+  sysNames.push_back("");
+  for (int i = 1; i < nSys; i++) sysNames.push_back("__SYS" + std::to_string(i) + "__1up");
+
+  // Book the same histograms in both stores
+  std::map<std::string, TH1*> hMap1D;
+  HistRegistry registry;
+  for (const auto& channel : kChannels) {
+    for (const auto& prefix : kPrefixes) {
+      for (const auto& sysName : sysNames) {
+        for (int v = 0; v < kNVariables; v++) {
+          std::string name = std::string("SM_study_") + channel + prefix + kVariables[v] + sysName;
+          TH1* h = new TH1F(name.c_str(), "", 100, 0., 1000.);
+          hMap1D[name] = h;
+          registry.Add(h);
+        }
+      }
+    }
+  }
+  std::cout << "Booked " << hMap1D.size() << " histograms" << std::endl;
+
+  const long nFills = (long)nEvents * sysNames.size() * 5 * 2 * kNVariables;
+
+  // Before: build the key and look it up for every fill
+  auto start = std::chrono::steady_clock::now();
+  for (int ev = 0; ev < nEvents; ev++) {
+    for (const auto& sysName : sysNames) {
+      for (const auto& c : kChannels) {
+        std::string channel = c;
+        for (const auto& p : kPrefixes) {
+          std::string hist_prefix = p;
+          for (int v = 0; v < kNVariables; v++) {
+            hMap1D["SM_study_"+channel+hist_prefix+kVariables[v]+sysName]->Fill(ev % 1000, 1.);
+          }
+        }
+      }
+    }
+  }
+  double tMap = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  // After: one block lookup per call, then fill through handles
+  start = std::chrono::steady_clock::now();
+  for (int ev = 0; ev < nEvents; ev++) {
+    for (const auto& sysName : sysNames) {
+      for (const auto& c : kChannels) {
+        std::string channel = c;
+        for (const auto& p : kPrefixes) {
+          std::string hist_prefix = p;
+          const int* hist = registry.Block(kBenchHists, channel, hist_prefix, sysName);
+          for (int v = 0; v < kNVariables; v++) {
+            registry.Fill1D(hist[v], ev % 1000, 1.);
+          }
+        }
+      }
+    }
+  }
+  double tRegistry = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << "Fills per method      : " << nFills << std::endl;
+  std::cout << "std::map string keys  : " << nFills / tMap << " fills/s (" << tMap << " s)" << std::endl;
+  std::cout << "HistRegistry handles  : " << nFills / tRegistry << " fills/s (" << tRegistry << " s)" << std::endl;
+  std::cout << "Speed-up              : " << tMap / tRegistry << std::endl;
+  if (registry.MissedFills() > 0) std::cout << "WARNING: " << registry.MissedFills() << " fills missed" << std::endl;
+
+  // Event weights (e.g. PDF replicas): one TH1 per weight, filled one by one or as a block
+  std::vector<TH1*> perWeight, grouped;
+  for (int i = 0; i < nWeights; i++) {
+    perWeight.push_back(new TH1F(("perWeight_" + std::to_string(i)).c_str(), "", 100, 0., 1000.));
+    grouped.push_back(new TH1F(("grouped_" + std::to_string(i)).c_str(), "", 100, 0., 1000.));
+  }
+  MultiWeightHist multiWeight(grouped);
+  std::vector<double> weights(nWeights);
+  const long nEventFills = (long)nEvents * sysNames.size() * 10; // ten weighted variables per event and systematic
+
+  start = std::chrono::steady_clock::now();
+  for (long ev = 0; ev < nEventFills; ev++) {
+    for (int i = 0; i < nWeights; i++) weights[i] = 1. + 0.001 * i;
+    for (int i = 0; i < nWeights; i++) perWeight[i]->Fill(ev % 1000, weights[i]);
+  }
+  double tPerWeight = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  for (long ev = 0; ev < nEventFills; ev++) {
+    for (int i = 0; i < nWeights; i++) weights[i] = 1. + 0.001 * i;
+    multiWeight.Fill(ev % 1000, weights.data());
+  }
+  multiWeight.Flush();
+  double tMultiWeight = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  double maxDiff = 0.;
+  for (int i = 0; i < nWeights; i++) {
+    for (int bin = 0; bin <= 101; bin++)
+      maxDiff = std::max(maxDiff, std::abs(perWeight[i]->GetBinContent(bin) - grouped[i]->GetBinContent(bin)) / std::max(1., perWeight[i]->GetBinContent(bin)));
+  }
+
+  std::cout << "Weighted fills        : " << nEventFills << " x " << nWeights << " weights" << std::endl;
+  std::cout << "one Fill per weight   : " << nEventFills / tPerWeight << " events/s (" << tPerWeight << " s)" << std::endl;
+  std::cout << "MultiWeightHist       : " << nEventFills / tMultiWeight << " events/s (" << tMultiWeight << " s)" << std::endl;
+  std::cout << "Speed-up              : " << tPerWeight / tMultiWeight << std::endl;
+  std::cout << "Max relative bin diff : " << maxDiff << std::endl;
+
+  for (auto& h : hMap1D) delete h.second;
+  for (int i = 0; i < nWeights; i++) {
+    delete perWeight[i];
+    delete grouped[i];
+  }
+
+  return 0;
+}
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <TMath.h>
+
+#include "smZInvAnalysis/KinematicKernels.h"
+
+// Kinematics benchmark: the scalar smZInvAnalysis::deltaPhi/deltaR in the
+// nested loops of the analysis against the KinematicKernels implementations,
+// on events with a given number of jets and leptons.
+
+namespace {
+
+  // Same as smZInvAnalysis::deltaPhi and deltaR
+  float deltaPhi(float phi1, float phi2) {
+    float dPhi = std::fabs(phi1 - phi2);
+    if(dPhi > TMath::Pi())
+      dPhi = TMath::TwoPi() - dPhi;
+    return dPhi;
+  }
+
+  float deltaR(float eta1, float eta2, float phi1, float phi2) {
+    float dEta = eta1 - eta2;
+    float dPhi = deltaPhi(phi1,phi2);
+    return TMath::Sqrt(dEta*dEta + dPhi*dPhi);
+  }
+
+  struct Event {
+    std::vector<float> jetEta, jetPhi, lepEta, lepPhi;
+    float metPhi;
+  };
+
+  double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+}
+
+int main( int argc, char* argv[] ) {
+
+  // Number of events, jets and leptons per event can be given as arguments
+  int nEvents = 200000;
+  unsigned int nJets = 12;
+  unsigned int nLeptons = 4;
+  if( argc > 1 ) nEvents = std::atoi( argv[ 1 ] );
+  if( argc > 2 ) nJets = std::atoi( argv[ 2 ] );
+  if( argc > 3 ) nLeptons = std::atoi( argv[ 3 ] );
+
+  std::mt19937 random(12345);
+  std::uniform_real_distribution<float> eta(-4.4, 4.4);
+  std::uniform_real_distribution<float> phi(-TMath::Pi(), TMath::Pi());
+  std::vector<Event> events(nEvents);
+  for (auto& event : events) {
+    for (unsigned int i = 0; i < nJets; i++) { event.jetEta.push_back(eta(random)); event.jetPhi.push_back(phi(random)); }
+    for (unsigned int i = 0; i < nLeptons; i++) { event.lepEta.push_back(eta(random)); event.lepPhi.push_back(phi(random)); }
+    event.metPhi = phi(random);
+  }
+  std::vector<float> dRmin(nJets), dR(nJets * nLeptons);
+
+  std::cout << nEvents << " events, " << nJets << " jets, " << nLeptons << " leptons" << std::endl;
+  std::cout << "Best implementation on this CPU: " << KinematicKernels::Name(KinematicKernels::Best()) << std::endl;
+
+  // Before: the loops of the jet selections and the jet-lepton overlap removal
+  double checksum = 0.;
+  auto start = std::chrono::steady_clock::now();
+  for (const auto& event : events) {
+    float dPhiMin = 9.;
+    for (unsigned int i = 0; i < nJets; i++) dPhiMin = std::min(dPhiMin, deltaPhi(event.jetPhi[i], event.metPhi));
+    checksum += dPhiMin;
+  }
+  double tPhiLoop = seconds(start);
+  start = std::chrono::steady_clock::now();
+  for (const auto& event : events) {
+    for (unsigned int i = 0; i < nJets; i++) {
+      float m = 9.;
+      for (unsigned int j = 0; j < nLeptons; j++) m = std::min(m, deltaR(event.jetEta[i], event.lepEta[j], event.jetPhi[i], event.lepPhi[j]));
+      checksum += m;
+    }
+  }
+  double tRLoop = seconds(start);
+  // the overlap subtraction: every jet-lepton pair
+  double matrixChecksum = 0.;
+  start = std::chrono::steady_clock::now();
+  for (const auto& event : events) {
+    for (unsigned int i = 0; i < nJets; i++)
+      for (unsigned int j = 0; j < nLeptons; j++) dR[i*nLeptons + j] = deltaR(event.jetEta[i], event.lepEta[j], event.jetPhi[i], event.lepPhi[j]);
+    for (unsigned int k = 0; k < nJets * nLeptons; k++) matrixChecksum += dR[k];
+  }
+  double tMatrixLoop = seconds(start);
+  std::cout << "scalar loops : minDeltaPhi " << tPhiLoop << " s, minDeltaR " << tRLoop << " s, all pairs " << tMatrixLoop << " s" << std::endl;
+
+  // After: each implementation this CPU supports
+  for (int impl = KinematicKernels::kScalar; impl < KinematicKernels::kNImplementations; impl++) {
+    if (!KinematicKernels::Select(KinematicKernels::Implementation(impl))) continue;
+
+    double kernelChecksum = 0.;
+    start = std::chrono::steady_clock::now();
+    for (const auto& event : events) kernelChecksum += KinematicKernels::MinDeltaPhi(event.jetPhi.data(), nJets, event.metPhi);
+    double tPhi = seconds(start);
+    start = std::chrono::steady_clock::now();
+    for (const auto& event : events) {
+      KinematicKernels::MinDeltaR(event.jetEta.data(), event.jetPhi.data(), nJets, event.lepEta.data(), event.lepPhi.data(), nLeptons, dRmin.data());
+      for (unsigned int i = 0; i < nJets; i++) kernelChecksum += dRmin[i];
+    }
+    double tR = seconds(start);
+    double kernelMatrixChecksum = 0.;
+    start = std::chrono::steady_clock::now();
+    for (const auto& event : events) {
+      KinematicKernels::DeltaR(event.jetEta.data(), event.jetPhi.data(), nJets, event.lepEta.data(), event.lepPhi.data(), nLeptons, dR.data());
+      for (unsigned int k = 0; k < nJets * nLeptons; k++) kernelMatrixChecksum += dR[k];
+    }
+    double tMatrix = seconds(start);
+
+    std::cout << KinematicKernels::Name(KinematicKernels::Selected()) << " kernels : minDeltaPhi " << tPhi << " s (x" << tPhiLoop / tPhi << ")"
+              << ", minDeltaR " << tR << " s (x" << tRLoop / tR << ")"
+              << ", all pairs " << tMatrix << " s (x" << tMatrixLoop / tMatrix << ")" << std::endl;
+    // float constants instead of the double TMath::Pi(): agreement to ~1e-6 per value
+    if (std::fabs(kernelChecksum - checksum) > 1e-5 * (1. + std::fabs(checksum)))
+      std::cout << "WARNING: " << KinematicKernels::Name(KinematicKernels::Selected()) << " checksum " << kernelChecksum << " differs from scalar loops " << checksum << std::endl;
+    if (std::fabs(kernelMatrixChecksum - matrixChecksum) > 1e-5 * (1. + std::fabs(matrixChecksum)))
+      std::cout << "WARNING: " << KinematicKernels::Name(KinematicKernels::Selected()) << " all-pairs checksum " << kernelMatrixChecksum << " differs from scalar loops " << matrixChecksum << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,25 @@
+#include <iostream>
+#include <string>
+
+#include "smZInvAnalysis/WeightVariationIndex.h"
+
+int main( int argc, char* argv[] ) {
+
+  // Convert the text weight table into the memory-mapped binary index read by smZInvAnalysis
+  std::string txtPath = "mcWeightVariations.txt";
+  std::string idxPath = "mcWeightVariations.idx";
+  if( argc > 1 ) txtPath = argv[ 1 ];
+  if( argc > 2 ) idxPath = argv[ 2 ];
+
+  if (!WeightVariationIndex::Build(txtPath, idxPath)) {
+    std::cerr << "Failed to build " << idxPath << " from " << txtPath << std::endl;
+    return 1;
+  }
+
+  // Read it back to make sure the file is usable
+  WeightVariationIndex index;
+  if (!index.Open(idxPath)) return 1;
+  std::cout << " Wrote " << index.Size() << " weight entries to " << idxPath << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,320 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <TClass.h>
+#include <TFile.h>
+#include <TH1.h>
+#include <THnSparse.h>
+#include <TKey.h>
+#include <TList.h>
+#include <TROOT.h>
+#include <TSystem.h>
+
+// Parallel replacement for hadd on the histogram outputs of smZInvAnalysis
+// (batch or grid jobs): every TH1/TH2/THnSparse with the same name is summed.
+//
+//   mergeAnalOutputs [-f] [-j N] [-m metadata.txt]... [-l lumi] [-dsid N] output.root input.root...
+//
+// The inputs are shared between N worker threads (default: all cores): each
+// takes the next unread file, reads it key by key and adds every object to its
+// own partial sum, so only one input object per thread is in memory besides
+// the partial sums. The partial sums are then combined in parallel, one
+// histogram name at a time, and written.
+//
+// With -m the MC histograms are normalised while merging: every input is
+// scaled by lumi x crossSection x kFactor x genFiltEff / sum of weights, from
+// the *_metadata.txt tables (crossSection in pb, lumi in pb^-1, default 1)
+// and the "sumOfWeights initial" of h_sumOfWeights, summed over all inputs of
+// the same DSID. The DSID is the first 6-digit field of the file name found in
+// the tables (e.g. hist-mc16_13TeV.364114.Sherpa_....root), or -dsid for all
+// inputs. The bookkeeping histograms (sum of weights, cutflows, timing,
+// memory) are summed without the scale.
+
+namespace {
+
+  // histograms summed unscaled when normalising
+  const char* const kUnscaledPrefixes[] = {
+    "h_sumOfWeights", "h_scaledSumOfWeight", "h_dataType", "cutflow_hist", "timing_", "memory_"
+  };
+
+  struct SampleInfo {
+    double crossSection;
+    double kFactor;
+    double genFiltEff;
+  };
+
+  struct Partial {
+    std::unordered_map<std::string, TObject*> objects;
+    std::vector<std::string> order; // first-read order of the names
+  };
+
+  bool isUnscaled(const std::string& name){
+    for (const char* prefix : kUnscaledPrefixes)
+      if (name.compare(0, std::strlen(prefix), prefix) == 0) return true;
+    return false;
+  }
+
+  // dataset_number/I:crossSection/D:kFactor/D:genFiltEff/D, one DSID per line
+  bool readMetadata(const std::string& path, std::map<int, SampleInfo>& samples){
+    std::ifstream in(path.c_str());
+    if (!in) {
+      std::cerr << "Cannot open metadata table " << path << std::endl;
+      return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+      if (line.empty() || !std::isdigit(static_cast<unsigned char>(line[0]))) continue; // header
+      std::istringstream fields(line);
+      int dsid = 0;
+      SampleInfo info = {0., 0., 0.};
+      if (!(fields >> dsid >> info.crossSection >> info.kFactor >> info.genFiltEff)) {
+        std::cerr << "Cannot parse line \"" << line << "\" of " << path << std::endl;
+        return false;
+      }
+      samples[dsid] = info;
+    }
+    return true;
+  }
+
+  // first field of exactly 6 digits in the file name that is a DSID of the tables, or -1
+  int dsidFromName(const std::string& path, const std::map<int, SampleInfo>& samples){
+    std::string name = gSystem->BaseName(path.c_str());
+    for (size_t i = 0; i < name.size(); ) {
+      if (!std::isdigit(static_cast<unsigned char>(name[i]))) {
+        i++;
+        continue;
+      }
+      size_t end = i;
+      while (end < name.size() && std::isdigit(static_cast<unsigned char>(name[end]))) end++;
+      if (end - i == 6) {
+        int dsid = std::atoi(name.substr(i, 6).c_str());
+        if (samples.count(dsid)) return dsid;
+      }
+      i = end;
+    }
+    return -1;
+  }
+
+  // run task(i) for i in [0, nTasks) on nThreads threads, each taking the next free i
+  void runWorkers(unsigned int nThreads, unsigned int nTasks, const std::function<void(unsigned int, unsigned int)>& task){
+    std::atomic<unsigned int> next(0);
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < nThreads; t++) {
+      threads.push_back(std::thread([&next, nTasks, t, &task]() {
+        for (unsigned int i = next++; i < nTasks; i = next++) task(t, i);
+      }));
+    }
+    for (std::thread& thread : threads) thread.join();
+  }
+
+  // add source to target (both TH1 or both THnSparse); Merge() also handles labelled and extendable axes, as in hadd
+  bool mergeInto(TObject* target, TObject* source){
+    TList list;
+    list.Add(source);
+    Long64_t status = -1;
+    if (TH1* h = dynamic_cast<TH1*>(target)) status = h->Merge(&list);
+    else if (THnSparse* h = dynamic_cast<THnSparse*>(target)) status = h->Merge(&list);
+    return status >= 0;
+  }
+
+  void scale(TObject* obj, double c){
+    if (TH1* h = dynamic_cast<TH1*>(obj)) h->Scale(c);
+    else if (THnSparse* h = dynamic_cast<THnSparse*>(obj)) h->Scale(c);
+  }
+
+}
+
+int main( int argc, char* argv[] ) {
+
+  bool force = false;
+  unsigned int nThreads = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::string> metadataPaths;
+  double lumi = 1.;
+  int fixedDsid = -1;
+  std::string outputPath;
+  std::vector<std::string> inputPaths;
+
+  for( int i = 1; i < argc; i++ ) {
+    std::string arg = argv[ i ];
+    bool hasValue = i + 1 < argc;
+    if( arg == "-f" ) force = true;
+    else if( arg == "-j" && hasValue ) nThreads = std::max(1, std::atoi( argv[ ++i ] ));
+    else if( arg == "-m" && hasValue ) metadataPaths.push_back( argv[ ++i ] );
+    else if( arg == "-l" && hasValue ) lumi = std::atof( argv[ ++i ] );
+    else if( arg == "-dsid" && hasValue ) fixedDsid = std::atoi( argv[ ++i ] );
+    else if( outputPath.empty() ) outputPath = arg;
+    else inputPaths.push_back( arg );
+  }
+  if( outputPath.empty() || inputPaths.empty() ) {
+    std::cerr << "Usage: " << argv[ 0 ] << " [-f] [-j threads] [-m metadata.txt]... [-l lumi/pb] [-dsid DSID] output.root input.root..." << std::endl;
+    return 1;
+  }
+  if( !force && !gSystem->AccessPathName( outputPath.c_str() ) ) {
+    std::cerr << outputPath << " exists, use -f to overwrite it" << std::endl;
+    return 1;
+  }
+  nThreads = std::min(nThreads, static_cast<unsigned int>(inputPaths.size()));
+
+  ROOT::EnableThreadSafety();
+  TH1::AddDirectory(kFALSE);
+
+  // Normalisation: DSID of each input, sum of weights of each DSID
+  const bool normalise = !metadataPaths.empty();
+  std::map<int, SampleInfo> samples;
+  std::vector<double> inputScale(inputPaths.size(), 1.);
+  if (normalise) {
+    for (const std::string& path : metadataPaths)
+      if (!readMetadata(path, samples)) return 1;
+    if (fixedDsid >= 0 && !samples.count(fixedDsid)) {
+      std::cerr << "DSID " << fixedDsid << " is not in the metadata tables" << std::endl;
+      return 1;
+    }
+
+    std::vector<int> inputDsid(inputPaths.size(), -1);
+    std::vector<double> inputSumW(inputPaths.size(), 0.);
+    std::atomic<bool> failed(false);
+    runWorkers(nThreads, inputPaths.size(), [&](unsigned int, unsigned int i) {
+      inputDsid[i] = fixedDsid >= 0 ? fixedDsid : dsidFromName(inputPaths[i], samples);
+      TFile* file = TFile::Open(inputPaths[i].c_str(), "READ");
+      TH1* sumOfWeights = file ? dynamic_cast<TH1*>(file->Get("h_sumOfWeights")) : 0;
+      if (inputDsid[i] < 0 || !sumOfWeights) {
+        std::cerr << inputPaths[i] << ": " << (inputDsid[i] < 0 ? "no DSID of the metadata tables in the file name" : "no h_sumOfWeights") << std::endl;
+        failed = true;
+      }
+      else {
+        inputSumW[i] = sumOfWeights->GetBinContent(1);
+      }
+      delete file;
+    });
+    if (failed) return 1;
+
+    std::map<int, double> sumW;
+    for (unsigned int i = 0; i < inputPaths.size(); i++) sumW[inputDsid[i]] += inputSumW[i];
+    for (std::map<int, double>::const_iterator it = sumW.begin(); it != sumW.end(); ++it) {
+      const SampleInfo& info = samples[it->first];
+      if (it->second == 0.) {
+        std::cerr << "DSID " << it->first << " has a sum of weights of 0" << std::endl;
+        return 1;
+      }
+      std::cout << " DSID " << it->first << ": xsec " << info.crossSection << " pb x kFactor " << info.kFactor
+        << " x genFiltEff " << info.genFiltEff << ", sum of weights " << it->second << std::endl;
+    }
+    for (unsigned int i = 0; i < inputPaths.size(); i++) {
+      const SampleInfo& info = samples[inputDsid[i]];
+      inputScale[i] = lumi * info.crossSection * info.kFactor * info.genFiltEff / sumW[inputDsid[i]];
+    }
+  }
+
+  // Stage 1: every thread sums the inputs it takes into its own partial sum
+  std::vector<Partial> partials(nThreads);
+  std::atomic<unsigned long> nSkipped(0);
+  std::atomic<bool> failed(false);
+  std::mutex printMutex;
+  runWorkers(nThreads, inputPaths.size(), [&](unsigned int thread, unsigned int i) {
+    Partial& partial = partials[thread];
+    TFile* file = TFile::Open(inputPaths[i].c_str(), "READ");
+    if (!file || file->IsZombie()) {
+      std::lock_guard<std::mutex> lock(printMutex);
+      std::cerr << "Cannot open " << inputPaths[i] << std::endl;
+      failed = true;
+      delete file;
+      return;
+    }
+
+    std::unordered_map<std::string, bool> seen;
+    TIter nextKey(file->GetListOfKeys());
+    while (TKey* key = static_cast<TKey*>(nextKey())) {
+      // keys are ordered by decreasing cycle, only the newest cycle of a name counts
+      std::string name = key->GetName();
+      if (seen[name]) continue;
+      seen[name] = true;
+
+      TClass* cl = TClass::GetClass(key->GetClassName());
+      if (!cl || !(cl->InheritsFrom(TH1::Class()) || cl->InheritsFrom(THnSparse::Class()))) {
+        nSkipped++;
+        continue;
+      }
+      TObject* obj = key->ReadObj();
+      if (TH1* h = dynamic_cast<TH1*>(obj)) h->SetDirectory(0);
+      if (normalise && !isUnscaled(name)) scale(obj, inputScale[i]);
+
+      std::unordered_map<std::string, TObject*>::iterator it = partial.objects.find(name);
+      if (it == partial.objects.end()) {
+        partial.objects[name] = obj;
+        partial.order.push_back(name);
+        continue;
+      }
+      if (!mergeInto(it->second, obj)) {
+        std::lock_guard<std::mutex> lock(printMutex);
+        std::cerr << "Cannot add " << name << " of " << inputPaths[i] << std::endl;
+        failed = true;
+      }
+      delete obj;
+    }
+    delete file;
+
+    std::lock_guard<std::mutex> lock(printMutex);
+    std::cout << " Read " << inputPaths[i] << std::endl;
+  });
+  if (failed) return 1;
+
+  // Stage 2: combine the partial sums, one name at a time
+  std::vector<std::string> names;
+  std::unordered_map<std::string, bool> known;
+  for (const Partial& partial : partials)
+    for (const std::string& name : partial.order)
+      if (!known[name]) {
+        known[name] = true;
+        names.push_back(name);
+      }
+
+  std::vector<TObject*> merged(names.size(), 0);
+  runWorkers(nThreads, names.size(), [&](unsigned int, unsigned int n) {
+    for (Partial& partial : partials) {
+      std::unordered_map<std::string, TObject*>::iterator it = partial.objects.find(names[n]);
+      if (it == partial.objects.end()) continue;
+      if (!merged[n]) {
+        merged[n] = it->second;
+        continue;
+      }
+      if (!mergeInto(merged[n], it->second)) {
+        std::lock_guard<std::mutex> lock(printMutex);
+        std::cerr << "Cannot add the partial sums of " << names[n] << std::endl;
+        failed = true;
+      }
+      delete it->second;
+    }
+  });
+  if (failed) return 1;
+
+  TFile* output = TFile::Open(outputPath.c_str(), "RECREATE");
+  if (!output || output->IsZombie()) {
+    std::cerr << "Cannot create " << outputPath << std::endl;
+    return 1;
+  }
+  for (unsigned int n = 0; n < names.size(); n++) {
+    output->WriteTObject(merged[n], names[n].c_str());
+    delete merged[n];
+  }
+  output->Close();
+  delete output;
+
+  std::cout << " Merged " << names.size() << " histograms from " << inputPaths.size() << " files into " << outputPath
+    << " with " << nThreads << " threads" << (normalise ? ", normalised to cross-section" : "") << std::endl;
+  if (nSkipped) std::cout << " Skipped " << nSkipped << " objects that are not histograms" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,181 @@
+#include "xAODRootAccess/Init.h"
+#include "EventLoop/Job.h"
+#include "EventLoop/DirectDriver.h"
+#include <TSystem.h>
+#include <TFileMerger.h>
+#include "SampleHandler/Sample.h"
+#include "SampleHandler/SampleLocal.h"
+#include "SampleHandler/SampleHandler.h"
+#include "SampleHandler/ScanDir.h"
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "smZInvAnalysis/smZInvAnalysis.h"
+
+// Run smZInvAnalysis on a whole batch node.
+//
+// The input files of every sample are cut into chunks of filesPerChunk files.
+// Up to nWorkers chunks are processed at the same time, each in its own
+// process with its own smZInvAnalysis instance (and therefore its own CP tools
+// and object containers); a worker pulls the next chunk as soon as one
+// finishes. Chunks are whole files so that the per-file MetaData
+// (CutBookkeepers sum of weights) is counted exactly once. At the end the
+// hist-<sample>.root outputs of all chunks are merged into submitDir.
+//
+// usage: nodeAnalRun [submitDir] [nWorkers] [filesPerChunk]
+
+namespace {
+
+  struct Chunk {
+    std::string sample;
+    std::vector<std::string> files;
+  };
+
+  // 0 if the chunk ran and wrote its histogram output, 1 otherwise (the exit status of the worker process)
+  int runChunk( const Chunk& chunk, const std::string& chunkDir ) {
+
+    if( !xAOD::Init().isSuccess() ) {
+      std::cerr << "nodeAnalRun: xAOD::Init failed for " << chunkDir << std::endl;
+      return 1;
+    }
+
+    SH::SampleHandler sh;
+    SH::SampleLocal* sample = new SH::SampleLocal( chunk.sample );
+    for( const auto& file : chunk.files ) sample->add( file );
+    sh.add( sample );
+    sh.setMetaString( "nc_tree", "CollectionTree" );
+
+    EL::Job job;
+    job.sampleHandler( sh );
+
+    smZInvAnalysis* alg = new smZInvAnalysis();
+    job.algsAdd( alg );
+
+    // the driver reports failures by throwing
+    EL::DirectDriver driver;
+    try {
+      driver.submit( job, chunkDir );
+    }
+    catch( const std::exception& e ) {
+      std::cerr << "nodeAnalRun: " << chunkDir << " failed: " << e.what() << std::endl;
+      return 1;
+    }
+
+    std::string histFile = chunkDir + "/hist-" + chunk.sample + ".root";
+    if( gSystem->AccessPathName( histFile.c_str() ) ) {
+      std::cerr << "nodeAnalRun: " << chunkDir << " wrote no " << histFile << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+
+}
+
+int main( int argc, char* argv[] ) {
+
+  // Take the submit directory, number of workers and chunk size from the input if provided:
+  std::string submitDir = "submitDir";
+  int nWorkers = sysconf( _SC_NPROCESSORS_ONLN );
+  int filesPerChunk = 1;
+  if( argc > 1 ) submitDir = argv[ 1 ];
+  if( argc > 2 ) nWorkers = std::atoi( argv[ 2 ] );
+  if( argc > 3 ) filesPerChunk = std::atoi( argv[ 3 ] );
+  if( nWorkers < 1 ) nWorkers = 1;
+  if( filesPerChunk < 1 ) filesPerChunk = 1;
+
+  if( !gSystem->AccessPathName( submitDir.c_str() ) ) {
+    std::cerr << "nodeAnalRun: " << submitDir << " already exists" << std::endl;
+    return 1;
+  }
+
+  // Construct the samples to run on (only the file lists are used here):
+  SH::SampleHandler sh;
+
+  const char* inputFilePath = gSystem->ExpandPathName ("/cluster/home/h/s/hson02/beaucheminlabHome/Dataset/MC/MC16a/derivation/EXOT5/mc16_13TeV.364164.Sherpa_221_NNPDF30NNLO_Wmunu_MAXHTPTV140_280_BFilter.deriv.DAOD_EXOT5.e5340_s3126_r9364_r9315_p3482");
+  SH::ScanDir().filePattern("DAOD_EXOT5.13472080._000*").scan(sh,inputFilePath); // 364164.Sherpa_221_NNPDF30NNLO_Wmunu_MAXHTPTV140_280_BFilter
+
+  // Print what we found:
+  sh.print();
+
+  // Cut every sample into chunks of whole files
+  std::vector<Chunk> chunks;
+  for( SH::SampleHandler::iterator iter = sh.begin(); iter != sh.end(); ++iter ) {
+    SH::Sample* sample = *iter;
+    for( unsigned int i = 0; i < sample->numFiles(); i++ ) {
+      if( i % filesPerChunk == 0 ) {
+        chunks.push_back( Chunk() );
+        chunks.back().sample = sample->name();
+      }
+      chunks.back().files.push_back( sample->fileName( i ) );
+    }
+  }
+  std::cout << "nodeAnalRun: " << chunks.size() << " chunks on " << nWorkers << " workers" << std::endl;
+
+  gSystem->mkdir( (submitDir + "/chunks").c_str(), kTRUE );
+
+  // Process the chunks, keeping at most nWorkers of them running
+  std::map<pid_t, unsigned int> running;
+  std::vector<unsigned int> failed;
+  unsigned int next = 0;
+  while( next < chunks.size() || !running.empty() ) {
+    while( next < chunks.size() && (int)running.size() < nWorkers ) {
+      std::string chunkDir = submitDir + "/chunks/chunk_" + std::to_string( next );
+      pid_t pid = fork();
+      if( pid < 0 ) {
+        std::cerr << "nodeAnalRun: fork failed for chunk " << next << std::endl;
+        return 1;
+      }
+      if( pid == 0 ) {
+        // _exit() does not flush stdio, so the output of the job would be lost when it goes to a file or pipe
+        int result = runChunk( chunks[next], chunkDir );
+        std::cout.flush();
+        std::cerr.flush();
+        fflush( nullptr );
+        _exit( result );
+      }
+      running[pid] = next;
+      next++;
+    }
+    int status = 0;
+    pid_t pid = waitpid( -1, &status, 0 );
+    if( pid < 0 ) break;
+    auto done = running.find( pid );
+    if( done == running.end() ) continue;
+    if( !WIFEXITED( status ) || WEXITSTATUS( status ) != 0 ) failed.push_back( done->second );
+    running.erase( done );
+  }
+
+  if( !failed.empty() ) {
+    for( const auto& i : failed ) std::cerr << "nodeAnalRun: chunk " << i << " (" << chunks[i].sample << ") failed" << std::endl;
+    return 1;
+  }
+
+  // Merge the histogram outputs of the chunks, one file per sample
+  std::map<std::string, std::vector<std::string> > histFiles;
+  for( unsigned int i = 0; i < chunks.size(); i++ ) {
+    histFiles[chunks[i].sample].push_back( submitDir + "/chunks/chunk_" + std::to_string( i ) + "/hist-" + chunks[i].sample + ".root" );
+  }
+  for( const auto& sample : histFiles ) {
+    std::string output = submitDir + "/hist-" + sample.first + ".root";
+    TFileMerger merger( kFALSE );
+    merger.OutputFile( output.c_str() );
+    for( const auto& file : sample.second ) merger.AddFile( file.c_str() );
+    if( !merger.Merge() ) {
+      std::cerr << "nodeAnalRun: failed to merge " << output << std::endl;
+      return 1;
+    }
+    std::cout << "nodeAnalRun: merged " << sample.second.size() << " chunks into " << output << std::endl;
+  }
+
+  return 0;
+}
@@ -26,6 +26,19 @@ int main( int argc, char* argv[] ) {
   std::string submitDir = "submitDir";
   if( argc > 1 ) submitDir = argv[ 1 ];
 
+  // Optional arguments after the submit directory:
+  //   "lazyhists" creates each histogram on its first fill (less memory, never-filled histograms are not written)
+  //   "sparsematrix" writes the unfolding matrices as THnSparseF
+  //   "memory" samples the memory use every 1000 events (see MemoryMonitor)
+  bool lazyHists = false;
+  bool sparseMatrix = false;
+  bool memoryMonitor = false;
+  for( int i = 2; i < argc; i++ ) {
+    if( std::string( argv[ i ] ) == "lazyhists" ) lazyHists = true;
+    if( std::string( argv[ i ] ) == "sparsematrix" ) sparseMatrix = true;
+    if( std::string( argv[ i ] ) == "memory" ) memoryMonitor = true;
+  }
+
   // Set up the job for xAOD access:
   xAOD::Init().ignore();
 
@@ -416,6 +429,11 @@ int main( int argc, char* argv[] ) {
   // Add our analysis to the job:
   smZInvAnalysis* alg = new smZInvAnalysis();
   job.algsAdd( alg );
+  // Histogram booking
+  alg->lazyHistBooking = lazyHists;
+  alg->sparseMatrices = sparseMatrix;
+  // Memory sampling
+  if( memoryMonitor ) alg->memoryMonitorInterval = 1000;
 
 /*
   // For ntuple
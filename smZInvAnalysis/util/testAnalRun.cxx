@@ -7,7 +7,6 @@
 #include "SampleHandler/DiskListLocal.h"
 #include <TSystem.h>
 #include "SampleHandler/ScanDir.h"
-#include <EventLoopAlgs/NTupleSvc.h>
 #include <EventLoop/OutputStream.h>
 
 #include "smZInvAnalysis/smZInvAnalysis.h"
@@ -18,6 +17,28 @@ int main( int argc, char* argv[] ) {
   std::string submitDir = "submitDir";
   if( argc > 1 ) submitDir = argv[ 1 ];
 
+  // Optional arguments after the submit directory:
+  //   "ntuple" writes the flat ntuple (see FlatNtuple)
+  //   "timing" writes the per-stage timing histograms (see StageTimer)
+  //   "truthonly" runs only the truth-level analysis (no reco tools), e.g. for unfolding
+  //   "lazyhists" creates each histogram on its first fill (less memory, never-filled histograms are not written)
+  //   "sparsematrix" writes the unfolding matrices as THnSparseF
+  //   "memory" samples the memory use every 1000 events (see MemoryMonitor)
+  bool writeNtuple = false;
+  bool doTiming = false;
+  bool truthOnly = false;
+  bool lazyHists = false;
+  bool sparseMatrix = false;
+  bool memoryMonitor = false;
+  for( int i = 2; i < argc; i++ ) {
+    if( std::string( argv[ i ] ) == "ntuple" ) writeNtuple = true;
+    if( std::string( argv[ i ] ) == "timing" ) doTiming = true;
+    if( std::string( argv[ i ] ) == "truthonly" ) truthOnly = true;
+    if( std::string( argv[ i ] ) == "lazyhists" ) lazyHists = true;
+    if( std::string( argv[ i ] ) == "sparsematrix" ) sparseMatrix = true;
+    if( std::string( argv[ i ] ) == "memory" ) memoryMonitor = true;
+  }
+
   // Set up the job for xAOD access:
   xAOD::Init().ignore();
 
@@ -325,24 +346,27 @@ int main( int argc, char* argv[] ) {
   EL::Job job;
   job.sampleHandler( sh );
   //job.options()->setDouble (EL::Job::optMaxEvents, 1000); // for testing
-/*
   // For ntuple
-  // define an output and an ntuple associated to that output (For ntuple)
-  EL::OutputStream output  ("myOutput");
-  job.outputAdd (output);
-  EL::NTupleSvc *ntuple = new EL::NTupleSvc ("myOutput");
-  job.algsAdd (ntuple);
-  //---------------------------------------------------------------------
-*/
+  // define an output stream for the flat ntuple (filled by the algorithm itself)
+  if( writeNtuple ) {
+    EL::OutputStream output( "ntuple" );
+    job.outputAdd( output );
+  }
   // Add our analysis to the job:
   smZInvAnalysis* alg = new smZInvAnalysis();
   job.algsAdd( alg );
-/*
   // For ntuple
-  // Let your algorithm know the name of the output file (For ntuple)
-  alg->outputName = "myOutput"; // give the name of the output to our algorithm
-  //----------------------------------------------------------------------------
-*/
+  // Let your algorithm know the name of the output stream
+  if( writeNtuple ) alg->outputName = "ntuple";
+  // Per-stage timing histograms (timing_hist, timing_calls)
+  alg->doTiming = doTiming;
+  // Truth-level analysis only
+  alg->truthOnly = truthOnly;
+  // Histogram booking
+  alg->lazyHistBooking = lazyHists;
+  alg->sparseMatrices = sparseMatrix;
+  // Memory sampling
+  if( memoryMonitor ) alg->memoryMonitorInterval = 1000;
   // Run the job using the local/direct driver:
   EL::DirectDriver driver;
   driver.submit( job, submitDir );
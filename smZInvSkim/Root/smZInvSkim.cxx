@@ -28,6 +28,9 @@
 
 #include <SampleHandler/MetaNames.h>
 
+#include <fstream>
+#include <sstream>
+
 struct DescendingPt:std::function<bool(const xAOD::IParticle*, const xAOD::IParticle*)> {
   bool operator()(const xAOD::IParticle* l, const xAOD::IParticle* r)  const {
     return l->pt() > r->pt();
@@ -50,6 +53,9 @@ smZInvSkim :: smZInvSkim ()
   // called on both the submission and the worker node.  Most of your
   // initialization code will go into histInitialize() and
   // initialize().
+
+  doSkim = true;
+  doSlim = true;
 }
 
 
@@ -106,6 +112,18 @@ EL::StatusCode smZInvSkim :: histInitialize ()
   h_dataType->SetCanExtend(TH1::kAllAxes);
   wk()->addOutput (h_dataType);
 
+  // Skim reduction in events and bytes
+  h_skimReduction = new TH1D("h_skimReduction", "Skim reduction", 4, 0.5, 4.5);
+  h_skimReduction -> GetXaxis() -> SetBinLabel(1, "nEvents input");
+  h_skimReduction -> GetXaxis() -> SetBinLabel(2, "nEvents output");
+  h_skimReduction -> GetXaxis() -> SetBinLabel(3, "bytes input");
+  h_skimReduction -> GetXaxis() -> SetBinLabel(4, "bytes output");
+  wk()->addOutput (h_skimReduction);
+
+  m_nEventsIn = 0;
+  m_nEventsOut = 0;
+  m_bytesIn = 0.;
+
 
   return EL::StatusCode::SUCCESS;
 }
@@ -137,6 +155,9 @@ EL::StatusCode smZInvSkim :: fileExecute ()
     m_isData = false; // can do something with this later
   }
 
+  // Input size for the skim report
+  m_bytesIn += wk()->inputFile()->GetSize();
+
   // Retrieve the Dataset name
   m_nameDataset = wk()->metaData()->castString (SH::MetaNames::sampleName());
   std::cout << " Dataset name = " << m_nameDataset << std::endl;
@@ -382,49 +403,8 @@ EL::StatusCode smZInvSkim :: initialize ()
   ANA_CHECK(m_muonCalibrationAndSmearingTool->initialize());
 
 
-/*
-  if (!m_isData) {
-    m_event->setAuxItemList("AntiKt4EMTopoJetsAux.", "pt.eta.phi.m.constituentLinks.constituentWeights.ConstituentScale.JetEMScaleMomentum_pt.JetEMScaleMomentum_eta.JetEMScaleMomentum_phi.JetEMScaleMomentum_m.JetConstitScaleMomentum_pt.JetConstitScaleMomentum_eta.JetConstitScaleMomentum_phi.JetConstitScaleMomentum_m.InputType.AlgorithmType.SizeParameter.btaggingLink.EnergyPerSampling.NumTrkPt500.SumPtTrkPt500.EMFrac.Width.LeadingClusterSecondR.Mu12.N90Constituents.NegativeE.NumTrkPt1000.OotFracClusters10.OotFracClusters5.OriginCorrected.OriginVertex.PartonTruthLabelID.PileupCorrected.PlanarFlow.Sphericity.Split12.Split23.Split34.SumPtTrkPt1000.Tau1.Tau1_wta.Tau2.Tau2_wta.Tau3.Tau3_wta.ThrustMaj.ThrustMin.Timing.TrackWidthPt1000.TrackWidthPt500.TruthLabelDeltaR_B.TruthLabelDeltaR_C.TruthLabelDeltaR_T.WidthPhi.ZCut12.ZCut23.ZCut34.ActiveArea.ActiveArea4vec_eta.ActiveArea4vec_m.ActiveArea4vec_phi.ActiveArea4vec_pt.Angularity.Aplanarity.AverageLArQF.BchCorrCell.CentroidR.Charge.ConeExclBHadronsFinal.ConeExclCHadronsFinal.ConeExclTausFinal.ConeTruthLabelID.DetectorEta.Dip12.Dip13.Dip23.DipExcl12.ECF1.ECF2.ECF3.ECPSFraction.FoxWolfram0.FoxWolfram1.FoxWolfram2.FoxWolfram3.FoxWolfram4.FracSamplingMax.FracSamplingMaxIndex.GhostAntiKt2TrackJet.GhostAntiKt2TrackJetCount.GhostAntiKt2TrackJetPt.GhostAntiKt3TrackJet.GhostAntiKt3TrackJetCount.GhostAntiKt3TrackJetPt.GhostAntiKt4TrackJet.GhostAntiKt4TrackJetCount.GhostAntiKt4TrackJetPt.GhostBHadronsFinal.GhostBHadronsFinalCount.GhostBHadronsFinalPt.GhostBHadronsInitial.GhostBHadronsInitialCount.GhostBHadronsInitialPt.GhostBQuarksFinal.GhostBQuarksFinalCount.GhostBQuarksFinalPt.GhostCHadronsFinal.GhostCHadronsFinalCount.GhostCHadronsFinalPt.GhostCHadronsInitial.GhostCHadronsInitialCount.GhostCHadronsInitialPt.GhostCQuarksFinal.GhostCQuarksFinalCount.GhostCQuarksFinalPt.GhostHBosons.GhostHBosonsCount.GhostHBosonsPt.GhostMuonSegment.GhostMuonSegmentCount.GhostPartons.GhostPartonsCount.GhostPartonsPt.GhostTQuarksFinal.GhostTQuarksFinalCount.GhostTQuarksFinalPt.GhostTausFinal.GhostTausFinalCount.GhostTausFinalPt.GhostTrack.GhostTrackCount.GhostTrackPt.GhostTruth.GhostTruthAssociationFraction.GhostTruthAssociationLink.GhostTruthCount.GhostTruthPt.GhostWBosons.GhostWBosonsCount.GhostWBosonsPt.GhostZBosons.GhostZBosonsCount.GhostZBosonsPt.HECFrac.HECQuality.HadronConeExclTruthLabelID.HighestJVFVtx.IsoDelta2SumPt.IsoDelta3SumPt.JVF.JetGhostArea.JetLCScaleMomentum_eta.JetLCScaleMomentum_m.JetLCScaleMomentum_phi.JetLCScaleMomentum_pt.JetOriginConstitScaleMomentum_eta.JetOriginConstitScaleMomentum_m.JetOriginConstitScaleMomentum_phi.JetOriginConstitScaleMomentum_pt.JetPileupScaleMomentum_eta.JetPileupScaleMomentum_m.JetPileupScaleMomentum_phi.JetPileupScaleMomentum_pt.Jvt.JvtJvfcorr.JvtRpt.KtDR.LArBadHVEnergyFrac.LArBadHVNCell.LArQuality.LeadingClusterCenterLambda.LeadingClusterPt.LeadingClusterSecondLambda"); 
-    m_event->setAuxItemList("MuonsAux.", "pt.eta.phi.muonSegmentLinks.charge.EnergyLoss.numberOfPrecisionHoleLayers.numberOfPrecisionLayers.truthParticleLink.etcone20.ptcone20.ptcone30.ptcone40.ptvarcone20.ptvarcone30.ptvarcone40.topoetcone20.topoetcone30.topoetcone40.truthOrigin.truthType.author.inDetTrackParticleLink.muonType.CaloLRLikelihood.CaloMuonIDTag.DFCommonGoodMuon.EnergyLossSigma.MeasEnergyLoss.MeasEnergyLossSigma.ParamEnergyLoss.ParamEnergyLossSigmaMinus.ParamEnergyLossSigmaPlus.clusterLink.combinedTrackOutBoundsPrecisionHits.combinedTrackParticleLink.energyLossType.etcone30.etcone40.extendedClosePrecisionHits.extendedLargeHits.extendedLargeHoles.extendedOutBoundsPrecisionHits.extendedSmallHits.extendedSmallHoles.extrapolatedMuonSpectrometerTrackParticleLink.innerClosePrecisionHits.innerLargeHits.innerLargeHoles.innerOutBoundsPrecisionHits.innerSmallHits.innerSmallHoles.isEndcapGoodLayers.isSmallGoodSectors.middleClosePrecisionHits.middleLargeHits.middleLargeHoles.middleOutBoundsPrecisionHits.middleSmallHits.middleSmallHoles.momentumBalanceSignificance.muonSpectrometerTrackParticleLink.numberOfGoodPrecisionLayers.outerClosePrecisionHits.outerLargeHits.outerLargeHoles.outerOutBoundsPrecisionHits.outerSmallHits.outerSmallHoles.quality"); 
-    m_event->setAuxItemList("ElectronsAux.",
-        "trackParticleLinks.pt.eta.phi.m.charge.truthParticleLink.deltaPhiRescaled2.e233.e237.e277.e2tsts1.emaxs1.emins1.etcone20.etcone20ptCorrection.etcone30ptCorrection.etcone40ptCorrection.ethad.ethad1.f1.f3.f3core.fracs1.ptcone20.ptcone30.ptcone40.ptvarcone20.ptvarcone30.ptvarcone40.topoetcone20.topoetcone20ptCorrection.topoetcone30.topoetcone30ptCorrection.topoetcone40.topoetcone40ptCorrection.truthOrigin.truthType.weta1.weta2.wtots1.DFCommonElectronsIsEMLoose.DFCommonElectronsIsEMMedium.DFCommonElectronsIsEMTight.DFCommonElectronsLHLoose.DFCommonElectronsLHMedium.DFCommonElectronsLHTight.DFCommonElectronsML.DeltaE.Eratio.LHLoose.Loose.Medium.OQ.Reta.Rhad.Rhad1.Rphi.Tight.author.caloClusterLinks.deltaEta1.deltaPhi2"); 
-    m_event->setAuxItemList("EventInfoAux.", "runNumber.eventNumber.eventTypeBitmask.averageInteractionsPerCrossing.beamPosSigmaX.beamPosSigmaY.beamPosSigmaXY.mcChannelNumber.mcEventWeights");
-    m_event->setAuxItemList("PhotonsAux.", "pt.eta.phi.m.truthParticleLink.e233.e237.e277.e2tsts1.emaxs1.emins1.etcone20ptCorrection.etcone30ptCorrection.etcone40ptCorrection.ethad.ethad1.f1.f3.fracs1.ptcone20.ptcone30.ptcone40.ptvarcone20.ptvarcone30.ptvarcone40.topoetcone20.topoetcone20ptCorrection.topoetcone30.topoetcone30ptCorrection.topoetcone40.topoetcone40ptCorrection.truthOrigin.truthType.weta1.weta2.wtots1.DeltaE.Eratio.Loose.OQ.Reta.Rhad.Rhad1.Rphi.Tight.author.caloClusterLinks.DFCommonPhotonsIsEMLoose.DFCommonPhotonsIsEMTight.vertexLinks"); 
-    m_event->setAuxItemList("TauJetsAux.",  "pt.eta.phi.m.trackLinks.wideTrackLinks.otherTrackLinks.jetLink.vertexLink.secondaryVertexLink.hadronicPFOLinks.shotPFOLinks.chargedPFOLinks.neutralPFOLinks.pi0PFOLinks.protoChargedPFOLinks.protoNeutralPFOLinks.protoPi0PFOLinks.charge.truthParticleLink.BDTJetScore.BDTEleScore.isTauFlags.IsTruthMatched.truthJetLink");
-  }
-  else {
-    m_event->setAuxItemList("AntiKt4EMTopoJetsAux.",
-        "pt.eta.phi.m.constituentLinks.constituentWeights.ConstituentScale.JetEMScaleMomentum_pt.JetEMScaleMomentum_eta.JetEMScaleMomentum_phi.JetEMScaleMomentum_m.JetConstitScaleMomentum_pt.JetConstitScaleMomentum_eta.JetConstitScaleMomentum_phi.JetConstitScaleMomentum_m.InputType.AlgorithmType.SizeParameter.btaggingLink.EnergyPerSampling.NumTrkPt500.SumPtTrkPt500.EMFrac.Width.ActiveArea.ActiveArea4vec_eta.ActiveArea4vec_m.ActiveArea4vec_phi.ActiveArea4vec_pt.Angularity.Aplanarity.AverageLArQF.BchCorrCell.CentroidR.Charge.DetectorEta.Dip12.Dip13.Dip23.DipExcl12.ECF1.ECF2.ECF3.ECPSFraction.FoxWolfram0.FoxWolfram1.FoxWolfram2.FoxWolfram3.FoxWolfram4.FracSamplingMax.FracSamplingMaxIndex.GhostAntiKt2TrackJet.GhostAntiKt2TrackJetCount.GhostAntiKt2TrackJetPt.GhostAntiKt3TrackJet.GhostAntiKt3TrackJetCount.GhostAntiKt3TrackJetPt.GhostAntiKt4TrackJet.GhostAntiKt4TrackJetCount.GhostAntiKt4TrackJetPt.GhostMuonSegment.GhostMuonSegmentCount.GhostTrack.GhostTrackCount.GhostTrackPt.HECFrac.HECQuality.HighestJVFVtx.IsoDelta2SumPt.IsoDelta3SumPt.JVF.JetGhostArea.JetLCScaleMomentum_eta.JetLCScaleMomentum_m.JetLCScaleMomentum_phi.JetLCScaleMomentum_pt.JetOriginConstitScaleMomentum_eta.JetOriginConstitScaleMomentum_m.JetOriginConstitScaleMomentum_phi.JetOriginConstitScaleMomentum_pt.JetPileupScaleMomentum_eta.JetPileupScaleMomentum_m.JetPileupScaleMomentum_phi.JetPileupScaleMomentum_pt.Jvt.JvtJvfcorr.JvtRpt.KtDR.LArBadHVEnergyFrac.LArBadHVNCell.LArQuality.LeadingClusterCenterLambda.LeadingClusterPt.LeadingClusterSecondLambda.LeadingClusterSecondR.Mu12.N90Constituents.NegativeE.NumTrkPt1000.OotFracClusters10.OotFracClusters5.OriginCorrected.OriginVertex.PileupCorrected.PlanarFlow.Sphericity.Split12.Split23.Split34.SumPtTrkPt1000.Tau1.Tau1_wta.Tau2.Tau2_wta.Tau3.Tau3_wta.ThrustMaj.ThrustMin.Timing.TrackWidthPt1000.TrackWidthPt500.WidthPhi.ZCut12.ZCut23.ZCut34"); 
-    m_event->setAuxItemList("MuonsAux.",
-        "pt.eta.phi.muonSegmentLinks.charge.EnergyLoss.numberOfPrecisionHoleLayers.numberOfPrecisionLayers.author.etcone20.ptcone20.ptcone30.ptcone40.ptvarcone20.ptvarcone30.ptvarcone40.topoetcone20.topoetcone30.topoetcone40.inDetTrackParticleLink.muonType.quality.truthOrigin.truthParticleLink.truthType.CaloLRLikelihood.CaloMuonIDTag.DFCommonGoodMuon.EnergyLossSigma.MeasEnergyLoss.MeasEnergyLossSigma.ParamEnergyLoss.ParamEnergyLossSigmaMinus.ParamEnergyLossSigmaPlus.clusterLink.combinedTrackOutBoundsPrecisionHits.combinedTrackParticleLink.energyLossType.etcone30.etcone40.extendedClosePrecisionHits.extendedLargeHits.extendedLargeHoles.extendedOutBoundsPrecisionHits.extendedSmallHits.extendedSmallHoles.extrapolatedMuonSpectrometerTrackParticleLink.innerClosePrecisionHits.innerLargeHits.innerLargeHoles.innerOutBoundsPrecisionHits.innerSmallHits.innerSmallHoles.isEndcapGoodLayers.isSmallGoodSectors.middleClosePrecisionHits.middleLargeHits.middleLargeHoles.middleOutBoundsPrecisionHits.middleSmallHits.middleSmallHoles.momentumBalanceSignificance.muonSpectrometerTrackParticleLink.numberOfGoodPrecisionLayers.outerClosePrecisionHits.outerLargeHits.outerLargeHoles.outerOutBoundsPrecisionHits.outerSmallHits.outerSmallHoles");
-    m_event->setAuxItemList("ElectronsAux.",
-        "trackParticleLinks.pt.eta.phi.m.charge.DFCommonElectronsIsEMLoose.DFCommonElectronsIsEMMedium.DFCommonElectronsIsEMTight.DFCommonElectronsLHLoose.DFCommonElectronsLHMedium.DFCommonElectronsLHTight.DFCommonElectronsML.DeltaE.Eratio.LHLoose.Loose.Medium.OQ.Reta.Rhad.Rhad1.Rphi.Tight.author.caloClusterLinks.deltaEta1.deltaPhi2.deltaPhiRescaled2.e233.e237.e277.e2tsts1.emaxs1.emins1.etcone20.etcone20ptCorrection.etcone30ptCorrection.etcone40ptCorrection.ethad.ethad1.f1.f3.f3core.fracs1.ptcone20.ptcone30.ptcone40.ptvarcone20.ptvarcone30.ptvarcone40.topoetcone20.topoetcone20ptCorrection.topoetcone30.topoetcone30ptCorrection.topoetcone40.topoetcone40ptCorrection.weta1.weta2.wtots1");
-    m_event->setAuxItemList("EventInfoAux.", "runNumber.eventNumber.lumiBlock.eventTypeBitmask.averageInteractionsPerCrossing.sctFlags.larFlags.tileFlags.coreFlags.beamPosSigmaX.beamPosSigmaY.beamPosSigmaXY");
-    m_event->setAuxItemList("PhotonsAux.", 
-        "pt.eta.phi.m.DeltaE.Eratio.Loose.OQ.Reta.Rhad.Rhad1.Rphi.Tight.author.caloClusterLinks.e233.e237.e277.e2tsts1.emaxs1.emins1.etcone20ptCorrection.etcone30ptCorrection.etcone40ptCorrection.ethad.ethad1.f1.f3.fracs1.ptcone20.ptcone30.ptcone40.ptvarcone20.ptvarcone30.ptvarcone40.topoetcone20.topoetcone20ptCorrection.topoetcone30.topoetcone30ptCorrection.topoetcone40.topoetcone40ptCorrection.weta1.weta2.wtots1.DFCommonPhotonsIsEMLoose.DFCommonPhotonsIsEMTight.vertexLinks"); 
-    m_event->setAuxItemList("TauJetsAux.",
-        "pt.eta.phi.m.trackLinks.wideTrackLinks.otherTrackLinks.jetLink.vertexLink.secondaryVertexLink.hadronicPFOLinks.shotPFOLinks.chargedPFOLinks.neutralPFOLinks.pi0PFOLinks.protoChargedPFOLinks.protoNeutralPFOLinks.protoPi0PFOLinks.charge.BDTEleScore.BDTJetScore.isTauFlags"); 
-  }
-  m_event->setAuxItemList("Kt4EMTopoEventShapeAux.", "Density");
-  m_event->setAuxItemList("CombinedMuonTrackParticlesAux.",  "phi.numberOfSCTHoles.numberOfSCTDeadSensors.d0.z0.theta.numberOfTRTHits.qOverP.numberOfTRTOutliers.definingParametersCovMatrix.vz.numberOfPixelHits.numberOfPixelHoles.chiSquared.numberOfPixelDeadSensors.numberDoF.numberOfSCTHits");
-  m_event->setAuxItemList("ExtrapolatedMuonTrackParticlesAux.", "phi.qOverP.theta.definingParametersCovMatrix");
-  m_event->setAuxItemList("GSFTrackParticlesAux.", "phi.d0.definingParametersCovMatrix.numberOfInnermostPixelLayerHits.numberOfPixelDeadSensors.numberOfPixelHits.numberOfSCTDeadSensors.numberOfSCTHits.numberOfTRTHits.numberOfTRTOutliers.qOverP.theta.vz.z0.eProbabilityHT.expectInnermostPixelLayerHit.expectNextToInnermostPixelLayerHit.numberOfInnermostPixelLayerOutliers.numberOfNextToInnermostPixelLayerHits.numberOfNextToInnermostPixelLayerOutliers.numberOfTRTHighThresholdHits.numberOfTRTHighThresholdOutliers.numberOfTRTXenonHits.parameterPX.parameterPY.parameterPZ.parameterPosition.parameterX"); 
-  m_event->setAuxItemList("GSFConversionVerticesAux.", "trackParticleLinks.px.py.pz.pt2.x.y.z.pt1");
-  m_event->setAuxItemList("InDetTrackParticlesAux.",
-      "phi.d0.definingParametersCovMatrix.numberOfPixelDeadSensors.numberOfPixelHits.numberOfPixelHoles.numberOfSCTDeadSensors.numberOfSCTHits.numberOfSCTHoles.numberOfTRTHits.numberOfTRTOutliers.qOverP.theta.vz.z0");
-  m_event->setAuxItemList("egammaClustersAux.", "PHICALOFRAME.calE.calEta.calPhi.e_sampl.eta_sampl.ETACALOFRAME");
-  m_event->setAuxItemList("PrimaryVerticesAux.", "trackParticleLinks.z.vertexType");
-  m_event->setAuxItemList("TruthEventsAux.", "truthParticleLinks.PDGID1.PDGID2.Q.X1.X2");
-  m_event->setAuxItemList("MET_TruthAux.", "name.mpx.mpy.sumet.source");
-  m_event->setAuxItemList("AntiKt4TruthJetsAux.", "pt.eta.phi.m.constituentLinks.constituentWeights.ConstituentScale.JetConstitScaleMomentum_pt.JetConstitScaleMomentum_eta.JetConstitScaleMomentum_phi.JetConstitScaleMomentum_m.InputType.AlgorithmType.SizeParameter.Width.Mu12.PartonTruthLabelID.PlanarFlow.Sphericity.Split12.Split23.Split34.Tau1.Tau1_wta.Tau2.Tau2_wta.Tau3.Tau3_wta.ThrustMaj.ThrustMin.TruthLabelDeltaR_B.TruthLabelDeltaR_C.TruthLabelDeltaR_T.WidthPhi.ZCut12.ZCut23.ZCut34.Angularity.Aplanarity.ConeExclBHadronsFinal.ConeExclCHadronsFinal.ConeExclTausFinal.ConeTruthLabelID.Dip12.Dip13.Dip23.DipExcl12.ECF1.ECF2.ECF3.FoxWolfram0.FoxWolfram1.FoxWolfram2.FoxWolfram3.FoxWolfram4.GhostBHadronsFinal.GhostBHadronsFinalCount.GhostBHadronsFinalPt.GhostBHadronsInitial.GhostBHadronsInitialCount.GhostBHadronsInitialPt.GhostBQuarksFinal.GhostBQuarksFinalCount.GhostBQuarksFinalPt.GhostCHadronsFinal.GhostCHadronsFinalCount.GhostCHadronsFinalPt.GhostCHadronsInitial.GhostCHadronsInitialCount.GhostCHadronsInitialPt.GhostCQuarksFinal.GhostCQuarksFinalCount.GhostCQuarksFinalPt.GhostHBosons.GhostHBosonsCount.GhostHBosonsPt.GhostPartons.GhostPartonsCount.GhostPartonsPt.GhostTQuarksFinal.GhostTQuarksFinalCount.GhostTQuarksFinalPt.GhostTausFinal.GhostTausFinalCount.GhostTausFinalPt.GhostWBosons.GhostWBosonsCount.GhostWBosonsPt.GhostZBosons.GhostZBosonsCount.GhostZBosonsPt.HadronConeExclTruthLabelID.IsoDelta2SumPt.IsoDelta3SumPt.JetGhostArea.KtDR");
-  m_event->setAuxItemList("METAssoc_AntiKt4EMTopoAux.", "jetLink.cale.calkey.calpx.calpy.calpz.calsumpt.isMisc.jettrke.jettrkpx.jettrkpy.jettrkpz.jettrksumpt.objectLinks.overlapIndices.overlapTypes.trke.trkkey.trkpx.trkpy.trkpz.trksumpt");
-  m_event->setAuxItemList("MET_Core_AntiKt4EMTopoAux.", "name.mpx.mpy.source.sumet");
-  m_event->setAuxItemList("xTrigDecisionAux.", "bgCode.tav.tap.tbp.lvl2PassedRaw.efPassedRaw.lvl2PassedThrough.efPassedThrough.lvl2Prescaled.efPrescaled.lvl2Resurrected.efResurrected");
-  m_event->setAuxItemList("TrigNavigationAux.", "serialized");
-  m_event->setAuxItemList("HLT_xAOD__MuonContainer_MuonEFInfoAux.", "pt.eta.phi");
-  m_event->setAuxItemList("HLT_xAOD__ElectronContainer_egamma_ElectronsAux.", "pt.eta.phi");
-  m_event->setAuxItemList("BTagging_AntiKt4EMTopo.", "MV2c20_discriminant");
-*/
+  // Slimming: keep only the whitelisted aux items of the current derivation
+  if (doSlim) ANA_CHECK(setAuxItemWhitelist());
 
 
 
@@ -451,6 +431,8 @@ EL::StatusCode smZInvSkim :: execute ()
     return EL::StatusCode::FAILURE;
   }
 
+  m_nEventsIn++;
+
   bool passUncalibMonojetCut = false;
   bool passRecoJetCuts = false;
   bool passTruthJetCuts = false;
@@ -612,11 +594,9 @@ EL::StatusCode smZInvSkim :: execute ()
 
 
   bool acceptEvent = passUncalibMonojetCut || passRecoJetCuts || passTruthJetCuts;
-  /*
-  if (!acceptEvent){
+  if (doSkim && !acceptEvent){
     return EL::StatusCode::SUCCESS; // go to next event
   }
-  */
 
 
 
@@ -747,6 +727,7 @@ EL::StatusCode smZInvSkim :: execute ()
   //ANA_CHECK(m_event->copy("JetETMissNeutralParticleFlowObjects"));
 
   m_event->fill();
+  m_nEventsOut++;
 
 
 
@@ -784,6 +765,15 @@ EL::StatusCode smZInvSkim :: finalize ()
   h_dataType->Write();
   ANA_CHECK(m_event->finishWritingTo( file_xAOD ));
 
+  // Skim report
+  double bytesOut = file_xAOD->GetSize();
+  h_skimReduction -> Fill(1, m_nEventsIn);
+  h_skimReduction -> Fill(2, m_nEventsOut);
+  h_skimReduction -> Fill(3, m_bytesIn);
+  h_skimReduction -> Fill(4, bytesOut);
+  Info("finalize()", "Skim kept %llu of %llu events (reduction factor %.2f)", m_nEventsOut, m_nEventsIn, m_nEventsOut > 0 ? double(m_nEventsIn)/m_nEventsOut : 0.);
+  Info("finalize()", "Skim wrote %.1f MB from %.1f MB input (reduction factor %.2f)", bytesOut/1.e6, m_bytesIn/1.e6, bytesOut > 0 ? m_bytesIn/bytesOut : 0.);
+
   // File Meta Data Tool
   if(m_fileMetaDataTool){
     delete m_fileMetaDataTool;
@@ -833,3 +823,46 @@ EL::StatusCode smZInvSkim :: histFinalize ()
   // they processed input events.
   return EL::StatusCode::SUCCESS;
 }
+
+
+
+EL::StatusCode smZInvSkim :: setAuxItemWhitelist ()
+{
+  // Read share/auxItems_<derivation>.conf and restrict the aux items
+  // written for every container listed there. Each line reads
+  //   <mc|data|all> <container>Aux. <item1.item2...>
+  // Containers that are not listed keep all their aux items.
+
+  ANA_CHECK_SET_TYPE (EL::StatusCode); // set type of return code you are expecting (add to top of each function once)
+
+  // (ex) m_dataType: StreamDAOD_EXOT5 -> EXOT5
+  std::string derivation = m_dataType;
+  if (derivation.find("StreamDAOD_") == 0) derivation = derivation.substr(11);
+
+  std::string fileName = PathResolverFindCalibFile("smZInvSkim/auxItems_" + derivation + ".conf");
+  std::ifstream whitelist(fileName.c_str());
+  if (fileName.empty() || !whitelist.is_open()) {
+    Warning("setAuxItemWhitelist()", "No aux-item whitelist for derivation '%s'. Writing all aux items.", derivation.c_str());
+    return EL::StatusCode::SUCCESS;
+  }
+
+  int nContainers = 0;
+  std::string line;
+  while (std::getline(whitelist, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream fields(line);
+    std::string scope, container, items;
+    if (!(fields >> scope >> container >> items)) {
+      Error("setAuxItemWhitelist()", "Malformed line in %s: %s", fileName.c_str(), line.c_str());
+      return EL::StatusCode::FAILURE;
+    }
+    if (scope == "mc" && m_isData) continue;
+    if (scope == "data" && !m_isData) continue;
+    m_event->setAuxItemList(container, items);
+    nContainers++;
+  }
+
+  Info("setAuxItemWhitelist()", "Slimming %i containers with %s", nContainers, fileName.c_str());
+
+  return EL::StatusCode::SUCCESS;
+}
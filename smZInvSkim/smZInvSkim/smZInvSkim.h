@@ -59,6 +59,11 @@ class smZInvSkim : public EL::Algorithm
 public:
   // float cutValue;
 
+  // Skim: reject events failing the uncalibrated/reco/truth jet cuts
+  bool doSkim;
+  // Slim: keep only the aux items listed in share/auxItems_<derivation>.conf
+  bool doSlim;
+
 
   // variables that don't get filled at submission time should be
   // protected from being send from the submission node to the worker
@@ -76,6 +81,12 @@ public:
   TFile *file_xAOD; //!
   TH1 *h_sumOfWeights; //!
   TH1 *h_dataType; //!
+  TH1 *h_skimReduction; //!
+
+  // Skim bookkeeping
+  unsigned long long m_nEventsIn; //!
+  unsigned long long m_nEventsOut; //!
+  double m_bytesIn; //!
 
   xAODMaker::FileMetaDataTool *m_fileMetaDataTool; //!
   xAODMaker::TriggerMenuMetaDataTool *m_triggerMenuMetaDataTool; //!
@@ -105,6 +116,9 @@ public:
   // this is a standard constructor
   smZInvSkim ();
 
+  // apply the aux-item whitelist of the current derivation to the output xAOD
+  EL::StatusCode setAuxItemWhitelist ();
+
 
   // these are the functions inherited from Algorithm
   virtual EL::StatusCode setupJob (EL::Job& job);
@@ -119,7 +133,7 @@ public:
 
 
   // this is needed to distribute the algorithm to the workers
-  ClassDef(smZInvSkim, 1);
+  ClassDef(smZInvSkim, 2);
 };
 
 #endif
@@ -112,6 +112,8 @@ int main( int argc, char* argv[] ) {
   // Add our analysis to the job:
   smZInvSkim* alg = new smZInvSkim();
   job.algsAdd( alg );
+  //alg->doSkim = false; // write every event
+  //alg->doSlim = false; // write all aux items (no share/auxItems_<derivation>.conf)
 /*
   // For ntuple
   // Let your algorithm know the name of the output file (For ntuple)